@@ -0,0 +1,168 @@
+#include "csa.h"
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
+
+
+ConnectionScanRouter::ConnectionScanRouter(const catalogue::TransportCatalogue& catalogue, double velocity) {
+	for (const catalogue::Stop& stop : catalogue.GetStops()) {
+		stop_ids_[&stop] = static_cast<uint32_t>(stops_.size());
+		stops_.push_back(&stop);
+	}
+
+	for (const catalogue::Bus* bus : catalogue.GetAllBuses()) {
+		if (bus->departures.empty()) {
+			continue;
+		}
+		const std::vector<std::vector<catalogue::Stop*>> trips = catalogue.GetTrips(bus);
+		std::vector<std::vector<double>> trip_times;
+		for (const auto& trip : trips) {
+			trip_times.push_back(catalogue.GetTripTimes(trip, velocity));
+		}
+		for (double departure : bus->departures) {
+			//the next trip starts when the previous one arrives
+			double trip_start = departure;
+			for (size_t k = 0; k < trips.size(); ++k) {
+				const uint32_t run = static_cast<uint32_t>(run_buses_.size());
+				run_buses_.push_back(bus);
+				for (uint32_t position = 0; position + 1 < trips[k].size(); ++position) {
+					connections_.push_back({ stop_ids_.at(trips[k][position]), stop_ids_.at(trips[k][position + 1]),
+						trip_start + trip_times[k][position], trip_start + trip_times[k][position + 1], run, position });
+				}
+				trip_start += trip_times[k].back();
+			}
+		}
+	}
+
+	//a run's connections keep their order, even at the same time
+	std::sort(connections_.begin(), connections_.end(), [](const Connection& lhs, const Connection& rhs) {
+		return std::tie(lhs.departure, lhs.arrival, lhs.run, lhs.position)
+			< std::tie(rhs.departure, rhs.arrival, rhs.run, rhs.position);
+	});
+}
+
+
+
+size_t ConnectionScanRouter::FindFirstConnection(double time) const {
+	return std::lower_bound(connections_.begin(), connections_.end(), time,
+		[](const Connection& connection, double value) { return connection.departure < value; }) - connections_.begin();
+}
+
+
+
+TransportRouteInfo ConnectionScanRouter::FindEarliestArrival(const catalogue::Stop* from, const catalogue::Stop* to, double departure_time) const {
+	if (from == nullptr || to == nullptr || stop_ids_.count(from) == 0 || stop_ids_.count(to) == 0) {
+		return { false, 0, {} };
+	}
+	if (from == to) {
+		return { true, 0, {} };
+	}
+	const uint32_t source = stop_ids_.at(from);
+	const uint32_t target = stop_ids_.at(to);
+	const double INF = std::numeric_limits<double>::infinity();
+	const size_t NO_CONNECTION = connections_.size();
+
+	std::vector<double> arrivals(stops_.size(), INF);
+	arrivals[source] = departure_time;
+	//connection where a run was boarded
+	std::vector<size_t> boarded(run_buses_.size(), NO_CONNECTION);
+	//(boarding, alighting) connections of the ride to a stop
+	std::vector<std::pair<size_t, size_t>> rides(stops_.size(), { NO_CONNECTION, NO_CONNECTION });
+
+	for (size_t i = FindFirstConnection(departure_time); i < connections_.size(); ++i) {
+		const Connection& connection = connections_[i];
+		if (arrivals[target] <= connection.departure) {
+			break;
+		}
+		if (boarded[connection.run] == NO_CONNECTION && arrivals[connection.from] <= connection.departure) {
+			boarded[connection.run] = i;
+		}
+		if (boarded[connection.run] != NO_CONNECTION && connection.arrival < arrivals[connection.to]) {
+			arrivals[connection.to] = connection.arrival;
+			rides[connection.to] = { boarded[connection.run], i };
+		}
+	}
+
+	if (arrivals[target] == INF) {
+		return { false, 0, {} };
+	}
+	std::vector<RouteItem> items;
+	uint32_t stop = target;
+	while (stop != source) {
+		const Connection& board = connections_[rides[stop].first];
+		const Connection& alight = connections_[rides[stop].second];
+		items.push_back(BusItem{ run_buses_[board.run]->bus_name, alight.arrival - board.departure,
+			static_cast<int>(alight.position - board.position + 1) });
+		items.push_back(WaitItem{ stops_[board.from]->stop_name, board.departure - arrivals[board.from] });
+		stop = board.from;
+	}
+	std::reverse(items.begin(), items.end());
+	return { true, arrivals[target] - departure_time, items };
+}
+
+
+
+std::vector<ProfileEntry> ConnectionScanRouter::FindProfile(const catalogue::Stop* from, const catalogue::Stop* to,
+	double window_begin, double window_end) const {
+	if (from == nullptr || to == nullptr || from == to || stop_ids_.count(from) == 0 || stop_ids_.count(to) == 0) {
+		return {};
+	}
+	const uint32_t source = stop_ids_.at(from);
+	const uint32_t target = stop_ids_.at(to);
+	const double INF = std::numeric_limits<double>::infinity();
+
+	//Pareto trips to the target from every stop, latest departure first
+	std::vector<std::vector<ProfileEntry>> profiles(stops_.size());
+	//earliest arrival at the target staying on the run
+	std::vector<double> run_arrivals(run_buses_.size(), INF);
+
+	//a trip of the profile arrives not later than the one leaving at window_end:
+	//connections leaving after that arrival are not scanned
+	const TransportRouteInfo latest = FindEarliestArrival(from, to, window_end);
+	const size_t last = latest.rout_exists
+		? std::upper_bound(connections_.begin(), connections_.end(), window_end + latest.total_time,
+			[](double value, const Connection& connection) { return value < connection.departure; }) - connections_.begin()
+		: connections_.size();
+	const size_t first = FindFirstConnection(window_begin);
+	for (size_t i = last; i-- > first;) {
+		const Connection& connection = connections_[i];
+		//leaving the origin later than the window is not an option (and never helps: transfers are free)
+		if (connection.from == source && connection.departure > window_end) {
+			continue;
+		}
+		double arrival = connection.to == target ? connection.arrival : INF;
+		arrival = std::min(arrival, run_arrivals[connection.run]);
+		//transfer: the earliest departure from the next stop not before the arrival there
+		const std::vector<ProfileEntry>& next = profiles[connection.to];
+		auto transfer = std::partition_point(next.begin(), next.end(),
+			[&connection](const ProfileEntry& entry) { return entry.departure_time >= connection.arrival; });
+		if (transfer != next.begin()) {
+			arrival = std::min(arrival, std::prev(transfer)->arrival_time);
+		}
+		run_arrivals[connection.run] = arrival;
+		if (arrival == INF) {
+			continue;
+		}
+
+		std::vector<ProfileEntry>& profile = profiles[connection.from];
+		if (profile.empty() || arrival < profile.back().arrival_time) {
+			if (!profile.empty() && profile.back().departure_time == connection.departure) {
+				profile.back().arrival_time = arrival;
+			}
+			else {
+				profile.push_back({ connection.departure, arrival });
+			}
+		}
+	}
+
+	std::vector<ProfileEntry> result(profiles[source].rbegin(), profiles[source].rend());
+	return result;
+}
+
+
+
+size_t ConnectionScanRouter::GetConnectionCount() const {
+	return connections_.size();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+
+/// <summary>
+/// A Pareto-optimal trip of a profile: leave the origin at departure_time, arrive at arrival_time
+/// (minutes since midnight). No other trip leaves later and arrives earlier.
+/// </summary>
+struct ProfileEntry {
+	double departure_time;
+	double arrival_time;
+};
+
+
+/// <summary>
+/// Timetable routes by the Connection Scan Algorithm: every ride between two consecutive stops of
+/// a run (same runs as TimetableRouter) is a connection, all of them in one array sorted by
+/// departure time. A query is a single linear scan of that array: forwards from the departure
+/// time for the earliest arrival, backwards for a profile. Transfers take no time.
+/// </summary>
+class ConnectionScanRouter {
+public:
+	ConnectionScanRouter(const catalogue::TransportCatalogue& catalogue, double velocity);
+
+	/// <summary>
+	/// Earliest arrival at to, leaving from not before departure_time. Same items as TimetableRouter.
+	/// </summary>
+	TransportRouteInfo FindEarliestArrival(const catalogue::Stop* from, const catalogue::Stop* to, double departure_time) const;
+
+	/// <summary>
+	/// All the Pareto-optimal trips leaving from between window_begin and window_end,
+	/// by departure time.
+	/// </summary>
+	std::vector<ProfileEntry> FindProfile(const catalogue::Stop* from, const catalogue::Stop* to,
+		double window_begin, double window_end) const;
+
+	size_t GetConnectionCount() const;
+
+private:
+	/// <summary>
+	/// Ride of a run between the stops at position and position + 1 of its trip.
+	/// </summary>
+	struct Connection {
+		uint32_t from;
+		uint32_t to;
+		double departure;
+		double arrival;
+		uint32_t run;
+		uint32_t position;
+	};
+
+	static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+	/// <summary>
+	/// First connection leaving not before time.
+	/// </summary>
+	size_t FindFirstConnection(double time) const;
+
+	std::vector<const catalogue::Stop*> stops_;
+	std::unordered_map<const catalogue::Stop*, uint32_t> stop_ids_;
+
+	std::vector<Connection> connections_;
+	//bus of every run
+	std::vector<const catalogue::Bus*> run_buses_;
+};
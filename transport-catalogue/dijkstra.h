@@ -0,0 +1,418 @@
+#pragma once
+
+#include "graph.h"
+#include "radix_heap.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    /// <summary>
+    /// FORWARD: distances from the sources along the edges.
+    /// BACKWARD: distances to the sources, the edges are followed in reverse.
+    /// </summary>
+    enum class SearchDirection {
+        FORWARD,
+        BACKWARD
+    };
+
+    /// <summary>
+    /// Dijkstra search over a DirectedWeightedGraph from one or several sources.
+    /// The object keeps its arrays between searches and only resets the touched vertexes,
+    /// so one object can answer many queries. Not thread safe: use one object per thread.
+    /// </summary>
+    template <typename Weight>
+    class ShortestPathSearch {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename Router<Weight>::RouteInfo;
+
+        /// <summary>
+        /// Weight of an edge, to search with other weights than the ones stored in the graph.
+        /// </summary>
+        using WeightFunction = std::function<Weight(EdgeId)>;
+
+        explicit ShortestPathSearch(const Graph& graph, WeightFunction weight = {},
+            SearchDirection direction = SearchDirection::FORWARD);
+
+        /// <summary>
+        /// Forget the previous search.
+        /// </summary>
+        void Reset();
+
+        /// <summary>
+        /// Add a source with an initial distance.
+        /// </summary>
+        void AddSource(VertexId source, Weight offset = ZERO_WEIGHT);
+
+        /// <summary>
+        /// Settle vertexes until every target is settled or no vertex is left.
+        /// </summary>
+        void RunUntilSettled(const std::vector<VertexId>& targets);
+
+        /// <summary>
+        /// Settle every reachable vertex.
+        /// </summary>
+        void Run();
+
+        /// <summary>
+        /// Settle only the vertexes at distance not greater than budget and return them,
+        /// closest first. Vertexes beyond the budget are never expanded.
+        /// </summary>
+        std::vector<VertexId> RunWithin(Weight budget);
+
+        /// <summary>
+        /// Pop the closest queued vertex, settle it and relax its edges.
+        /// Return the settled vertex or std::nullopt when no vertex is left.
+        /// </summary>
+        std::optional<VertexId> SettleNext();
+
+        /// <summary>
+        /// Distance of the next vertex to settle, std::nullopt when no vertex is left.
+        /// No vertex settled later is closer.
+        /// </summary>
+        std::optional<Weight> GetNextDistance();
+
+        bool IsSettled(VertexId vertex) const;
+
+        /// <summary>
+        /// Best distance found so far to a queued or settled vertex (final once settled),
+        /// std::nullopt for a vertex not reached yet.
+        /// </summary>
+        std::optional<Weight> GetTentativeDistance(VertexId vertex) const;
+
+        /// <summary>
+        /// Weight of an edge in this search.
+        /// </summary>
+        Weight GetWeight(EdgeId edge_id) const;
+
+        /// <summary>
+        /// Shortest distance to a settled vertex, std::nullopt otherwise.
+        /// </summary>
+        std::optional<Weight> GetDistance(VertexId vertex) const;
+
+        /// <summary>
+        /// Edges from the source to a settled vertex, in the same form as Router::BuildRoute.
+        /// BACKWARD: edges from the vertex to the source, in the order they are travelled.
+        /// </summary>
+        std::optional<RouteInfo> BuildRoute(VertexId to) const;
+
+    private:
+        enum class State : char {
+            UNSEEN,
+            QUEUED,
+            SETTLED
+        };
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+        void Touch(VertexId vertex);
+
+        const Graph& graph_;
+        //empty: the weights of the graph
+        WeightFunction weight_;
+        SearchDirection direction_;
+        std::vector<Weight> distances_;
+        std::vector<EdgeId> prev_edges_;
+        std::vector<State> states_;
+        std::vector<VertexId> touched_;
+        SearchQueue<Weight> queue_;
+    };
+
+    template <typename Weight>
+    ShortestPathSearch<Weight>::ShortestPathSearch(const Graph& graph, WeightFunction weight,
+        SearchDirection direction)
+        : graph_(graph)
+        , weight_(std::move(weight))
+        , direction_(direction)
+        , distances_(graph.GetVertexCount())
+        , prev_edges_(graph.GetVertexCount(), NO_EDGE)
+        , states_(graph.GetVertexCount(), State::UNSEEN) {
+    }
+
+    template <typename Weight>
+    void ShortestPathSearch<Weight>::Reset() {
+        for (const VertexId vertex : touched_) {
+            states_[vertex] = State::UNSEEN;
+            prev_edges_[vertex] = NO_EDGE;
+        }
+        touched_.clear();
+        queue_ = {};
+    }
+
+    template <typename Weight>
+    void ShortestPathSearch<Weight>::Touch(VertexId vertex) {
+        if (states_[vertex] == State::UNSEEN) {
+            touched_.push_back(vertex);
+            states_[vertex] = State::QUEUED;
+        }
+    }
+
+    template <typename Weight>
+    void ShortestPathSearch<Weight>::AddSource(VertexId source, Weight offset) {
+        if (states_.at(source) == State::UNSEEN || offset < distances_[source]) {
+            Touch(source);
+            distances_[source] = offset;
+            prev_edges_[source] = NO_EDGE;
+            queue_.push({ offset, source });
+        }
+    }
+
+    template <typename Weight>
+    std::optional<VertexId> ShortestPathSearch<Weight>::SettleNext() {
+        while (!queue_.empty()) {
+            const auto [distance, vertex] = queue_.top();
+            queue_.pop();
+            if (states_[vertex] == State::SETTLED || distances_[vertex] < distance) {
+                //outdated queue item
+                continue;
+            }
+            states_[vertex] = State::SETTLED;
+            const bool forward = direction_ == SearchDirection::FORWARD;
+            for (const EdgeId edge_id : forward ? graph_.GetIncidentEdges(vertex) : graph_.GetIncomingEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const VertexId next = forward ? edge.to : edge.from;
+                if (states_[next] == State::SETTLED) {
+                    continue;
+                }
+                const Weight weight = GetWeight(edge_id);
+                if (weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                const Weight candidate = distance + weight;
+                if (states_[next] == State::UNSEEN || candidate < distances_[next]) {
+                    Touch(next);
+                    distances_[next] = candidate;
+                    prev_edges_[next] = edge_id;
+                    queue_.push({ candidate, next });
+                }
+            }
+            return vertex;
+        }
+        return std::nullopt;
+    }
+
+    template <typename Weight>
+    void ShortestPathSearch<Weight>::RunUntilSettled(const std::vector<VertexId>& targets) {
+        size_t unsettled = 0;
+        std::vector<VertexId> sorted_targets(targets);
+        std::sort(sorted_targets.begin(), sorted_targets.end());
+        sorted_targets.erase(std::unique(sorted_targets.begin(), sorted_targets.end()), sorted_targets.end());
+        for (const VertexId target : sorted_targets) {
+            if (!IsSettled(target)) {
+                ++unsettled;
+            }
+        }
+
+        while (unsettled > 0) {
+            const std::optional<VertexId> settled = SettleNext();
+            if (!settled) {
+                return;
+            }
+            if (std::binary_search(sorted_targets.begin(), sorted_targets.end(), *settled)) {
+                --unsettled;
+            }
+        }
+    }
+
+    template <typename Weight>
+    void ShortestPathSearch<Weight>::Run() {
+        while (SettleNext()) {
+        }
+    }
+
+    template <typename Weight>
+    std::vector<VertexId> ShortestPathSearch<Weight>::RunWithin(Weight budget) {
+        std::vector<VertexId> settled;
+        for (std::optional<Weight> distance = GetNextDistance(); distance && !(budget < *distance); distance = GetNextDistance()) {
+            settled.push_back(*SettleNext());
+        }
+        return settled;
+    }
+
+    template <typename Weight>
+    std::optional<Weight> ShortestPathSearch<Weight>::GetNextDistance() {
+        while (!queue_.empty()) {
+            const auto [distance, vertex] = queue_.top();
+            if (states_[vertex] == State::SETTLED || distances_[vertex] < distance) {
+                //outdated queue item
+                queue_.pop();
+                continue;
+            }
+            return distance;
+        }
+        return std::nullopt;
+    }
+
+    template <typename Weight>
+    bool ShortestPathSearch<Weight>::IsSettled(VertexId vertex) const {
+        return states_.at(vertex) == State::SETTLED;
+    }
+
+    template <typename Weight>
+    std::optional<Weight> ShortestPathSearch<Weight>::GetTentativeDistance(VertexId vertex) const {
+        if (states_.at(vertex) == State::UNSEEN) {
+            return std::nullopt;
+        }
+        return distances_[vertex];
+    }
+
+    template <typename Weight>
+    Weight ShortestPathSearch<Weight>::GetWeight(EdgeId edge_id) const {
+        return weight_ ? weight_(edge_id) : graph_.GetEdge(edge_id).weight;
+    }
+
+    template <typename Weight>
+    std::optional<Weight> ShortestPathSearch<Weight>::GetDistance(VertexId vertex) const {
+        if (!IsSettled(vertex)) {
+            return std::nullopt;
+        }
+        return distances_[vertex];
+    }
+
+    template <typename Weight>
+    std::optional<typename ShortestPathSearch<Weight>::RouteInfo> ShortestPathSearch<Weight>::BuildRoute(VertexId to) const {
+        if (!IsSettled(to)) {
+            return std::nullopt;
+        }
+        const bool forward = direction_ == SearchDirection::FORWARD;
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = prev_edges_[to]; edge_id != NO_EDGE; ) {
+            edges.push_back(edge_id);
+            const auto& edge = graph_.GetEdge(edge_id);
+            edge_id = prev_edges_[forward ? edge.from : edge.to];
+        }
+        if (forward) {
+            std::reverse(edges.begin(), edges.end());
+        }
+        return RouteInfo{ distances_[to], std::move(edges) };
+    }
+
+    /// <summary>
+    /// Shortest route between two vertexes by two searches: forward from the source and
+    /// backward from the target (over the reverse incidence lists), advancing the side
+    /// with the closer next vertex. An edge scanned from one side to a vertex settled by
+    /// the other gives a route candidate; the search stops when the next distances of both
+    /// sides add up to the best candidate, as no route through unsettled vertexes can be
+    /// shorter. Each side explores a disc of about half the radius of a one-way search.
+    /// Not thread safe: use one object per thread.
+    /// </summary>
+    template <typename Weight>
+    class BidirectionalSearch {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename Router<Weight>::RouteInfo;
+        using WeightFunction = typename ShortestPathSearch<Weight>::WeightFunction;
+
+        explicit BidirectionalSearch(const Graph& graph, WeightFunction weight = {});
+
+        /// <summary>
+        /// Edges of a shortest route from -> to in the order they are travelled,
+        /// as Router::BuildRoute. std::nullopt if there is no route.
+        /// </summary>
+        std::optional<RouteInfo> FindRoute(VertexId from, VertexId to);
+
+        /// <summary>
+        /// Vertexes settled by both sides during the last FindRoute.
+        /// </summary>
+        size_t GetSettledCount() const;
+
+    private:
+        /// <summary>
+        /// Check the edges of a vertex just settled by search for routes through the other side.
+        /// </summary>
+        void ScanMeetings(VertexId vertex, SearchDirection direction);
+
+        const Graph& graph_;
+        ShortestPathSearch<Weight> forward_;
+        ShortestPathSearch<Weight> backward_;
+        //best route found: forward route to the edge, the edge, backward route from it
+        std::optional<Weight> best_weight_;
+        EdgeId meeting_edge_ = 0;
+        size_t settled_count_ = 0;
+    };
+
+    template <typename Weight>
+    BidirectionalSearch<Weight>::BidirectionalSearch(const Graph& graph, WeightFunction weight)
+        : graph_(graph)
+        , forward_(graph, weight, SearchDirection::FORWARD)
+        , backward_(graph, weight, SearchDirection::BACKWARD) {
+    }
+
+    template <typename Weight>
+    void BidirectionalSearch<Weight>::ScanMeetings(VertexId vertex, SearchDirection direction) {
+        const bool forward = direction == SearchDirection::FORWARD;
+        const ShortestPathSearch<Weight>& search = forward ? forward_ : backward_;
+        const ShortestPathSearch<Weight>& other = forward ? backward_ : forward_;
+        const Weight distance = *search.GetDistance(vertex);
+        for (const EdgeId edge_id : forward ? graph_.GetIncidentEdges(vertex) : graph_.GetIncomingEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const std::optional<Weight> other_distance = other.GetDistance(forward ? edge.to : edge.from);
+            if (!other_distance) {
+                continue;
+            }
+            const Weight candidate = distance + search.GetWeight(edge_id) + *other_distance;
+            if (!best_weight_ || candidate < *best_weight_) {
+                best_weight_ = candidate;
+                meeting_edge_ = edge_id;
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename BidirectionalSearch<Weight>::RouteInfo> BidirectionalSearch<Weight>::FindRoute(VertexId from,
+        VertexId to) {
+        forward_.Reset();
+        backward_.Reset();
+        best_weight_.reset();
+        settled_count_ = 0;
+        if (from == to) {
+            //validates the vertex as the searches do
+            forward_.AddSource(from);
+            return RouteInfo{ Weight{}, {} };
+        }
+        forward_.AddSource(from);
+        backward_.AddSource(to);
+
+        while (true) {
+            const std::optional<Weight> forward_next = forward_.GetNextDistance();
+            const std::optional<Weight> backward_next = backward_.GetNextDistance();
+            if (!forward_next || !backward_next
+                || (best_weight_ && !(*forward_next + *backward_next < *best_weight_))) {
+                break;
+            }
+            const bool forward = !(*backward_next < *forward_next);
+            const VertexId vertex = *(forward ? forward_ : backward_).SettleNext();
+            ++settled_count_;
+            ScanMeetings(vertex, forward ? SearchDirection::FORWARD : SearchDirection::BACKWARD);
+        }
+
+        if (!best_weight_) {
+            return std::nullopt;
+        }
+        const auto& edge = graph_.GetEdge(meeting_edge_);
+        std::vector<EdgeId> edges = std::move(forward_.BuildRoute(edge.from)->edges);
+        edges.push_back(meeting_edge_);
+        const std::vector<EdgeId> to_target = std::move(backward_.BuildRoute(edge.to)->edges);
+        edges.insert(edges.end(), to_target.begin(), to_target.end());
+        return RouteInfo{ *best_weight_, std::move(edges) };
+    }
+
+    template <typename Weight>
+    size_t BidirectionalSearch<Weight>::GetSettledCount() const {
+        return settled_count_;
+    }
+
+}  // namespace graph
@@ -3,14 +3,24 @@
 
 namespace catalogue {
 
-	double Bus::GetRouteGeoLength() const {
-		double route = 0.0;
-		for (size_t a = 0; a <= stops.size() - 2; ++a) {
-			geo::Coordinates start = (*stops[a]).location;
-			geo::Coordinates finish = (*stops[a + 1]).location;
-			route += ComputeDistance(start, finish);
-		}
-		return route;
+	size_t StopColumns::size() const {
+		return lat.size();
+	}
+
+	geo::Coordinates StopColumns::GetCoordinates(size_t id) const {
+		return { lat[id], lng[id] };
+	}
+
+	std::string_view StopColumns::GetName(size_t id) const {
+		return std::string_view(name_arena).substr(name_offsets[id], name_offsets[id + 1] - name_offsets[id]);
+	}
+
+	void StopColumns::Add(std::string_view name, geo::Coordinates coordinates) {
+		lat.push_back(coordinates.lat);
+		lng.push_back(coordinates.lng);
+		name_arena.append(name);
+		name_offsets.push_back(name_arena.size());
+		trig.Add(coordinates);
 	}
 	
 	size_t Bus::CountUniqueStops() const {
@@ -18,7 +28,74 @@ namespace catalogue {
 	}
 
 	bool Bus::IsRoundTrip() const {
-		return end_stop == *stops.begin();
+		return kind == RouteKind::ROUND_TRIP;
+	}
+
+	Stop* Bus::GetEndStop() const {
+		if (stops.empty()) {
+			return nullptr;
+		}
+		return IsRoundTrip() ? stops.front() : stops.back();
+	}
+
+	RouteView Bus::GetFullRoute() const {
+		return RouteView(stops, kind);
+	}
+
+
+	RouteView::RouteView(const std::vector<Stop*>& stops, RouteKind kind)
+		: stops_(&stops)
+		, kind_(kind) {
+	}
+
+	size_t RouteView::size() const {
+		if (kind_ == RouteKind::ROUND_TRIP || stops_->empty()) {
+			return stops_->size();
+		}
+		return 2 * stops_->size() - 1;
+	}
+
+	namespace {
+
+		//the way back of a straight line: the same stops in reverse
+		Stop* GetRouteStop(const std::vector<Stop*>& stops, size_t position) {
+			return position < stops.size() ? stops[position] : stops[2 * stops.size() - 2 - position];
+		}
+
+	}
+
+	Stop* RouteView::operator[](size_t position) const {
+		return GetRouteStop(*stops_, position);
+	}
+
+	RouteView::Iterator RouteView::begin() const {
+		return Iterator(stops_, 0);
+	}
+
+	RouteView::Iterator RouteView::end() const {
+		return Iterator(stops_, size());
+	}
+
+	RouteView::Iterator::Iterator(const std::vector<Stop*>* stops, size_t position)
+		: stops_(stops)
+		, position_(position) {
+	}
+
+	Stop* RouteView::Iterator::operator*() const {
+		return GetRouteStop(*stops_, position_);
+	}
+
+	RouteView::Iterator& RouteView::Iterator::operator++() {
+		++position_;
+		return *this;
+	}
+
+	bool RouteView::Iterator::operator==(const Iterator& other) const {
+		return position_ == other.position_;
+	}
+
+	bool RouteView::Iterator::operator!=(const Iterator& other) const {
+		return !(*this == other);
 	}
 
 }
\ No newline at end of file
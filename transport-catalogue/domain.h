@@ -1,5 +1,8 @@
 #pragma once
+#include <cstddef>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include "geo.h"
@@ -15,6 +18,31 @@ namespace catalogue {
 	public:
 		std::string stop_name;
 		geo::Coordinates location;
+		//position in TransportCatalogue::GetStops() and in its StopColumns
+		size_t id = 0;
+	};
+
+
+	/// <summary>
+	/// The stops as columns, by stop id. A pass over the coordinates reads only them:
+	/// latitudes and longitudes are contiguous, the names are kept apart in one arena.
+	/// </summary>
+	struct StopColumns {
+		std::vector<double> lat;
+		std::vector<double> lng;
+		//name of the stop id: name_arena[name_offsets[id], name_offsets[id + 1])
+		std::string name_arena;
+		std::vector<size_t> name_offsets = { 0 };
+		//sin/cos of the coordinates, taken once in Add: distances between stops need no more
+		geo::TrigTerms trig;
+
+		size_t size() const;
+
+		geo::Coordinates GetCoordinates(size_t id) const;
+
+		std::string_view GetName(size_t id) const;
+
+		void Add(std::string_view name, geo::Coordinates coordinates);
 	};
 
 
@@ -29,23 +57,85 @@ namespace catalogue {
 	};
 
 	
+	/// <summary>
+	/// A round trip comes back to its first stop by itself; a straight line goes to its last stop
+	/// and back through the same stops in reverse.
+	/// </summary>
+	enum class RouteKind {
+		ROUND_TRIP,
+		STRAIGHT
+	};
+
+
+	/// <summary>
+	/// All the stops of a bus line in the order of the ride, the way back of a straight line
+	/// included, read from its one-way stops without copying them.
+	/// </summary>
+	class RouteView {
+	public:
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Stop*;
+			using difference_type = std::ptrdiff_t;
+			using pointer = Stop* const*;
+			using reference = Stop*;
+
+			Iterator(const std::vector<Stop*>* stops, size_t position);
+
+			Stop* operator*() const;
+			Iterator& operator++();
+			bool operator==(const Iterator& other) const;
+			bool operator!=(const Iterator& other) const;
+
+		private:
+			const std::vector<Stop*>* stops_;
+			size_t position_;
+		};
+
+		RouteView(const std::vector<Stop*>& stops, RouteKind kind);
+
+		size_t size() const;
+
+		Stop* operator[](size_t position) const;
+
+		Iterator begin() const;
+		Iterator end() const;
+
+	private:
+		const std::vector<Stop*>* stops_;
+		RouteKind kind_;
+	};
+
+	
 	/// <summary>
 	/// Defines a Bus
 	/// </summary>
 	class Bus {
 	public:
 		std::string bus_name;
+		//one way: the way back of a STRAIGHT line is not stored (see GetFullRoute)
 		std::vector<Stop*> stops;
 
-		//for round_trip: end=start, otherwise end !=start
-		Stop* end_stop;
+		RouteKind kind = RouteKind::ROUND_TRIP;
 
-		double GetRouteGeoLength() const; 
+		//minutes since midnight at which the bus leaves its first stop, sorted (may be empty)
+		std::vector<double> departures;
 
 		size_t CountUniqueStops() const; 
 
 		bool IsRoundTrip() const;
 
+		/// <summary>
+		/// Last stop of the way there: the first one for a round trip (nullptr without stops).
+		/// </summary>
+		Stop* GetEndStop() const;
+
+		/// <summary>
+		/// All the stops of the ride: 2n - 1 for a straight line of n stops.
+		/// </summary>
+		RouteView GetFullRoute() const;
+
 
 
 	};
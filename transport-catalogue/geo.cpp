@@ -1,8 +1,13 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
 
 namespace catalogue {
 
@@ -16,7 +21,63 @@ namespace catalogue {
             static const double dr = M_PI / 180.;
             return acos(sin(from.lat * dr) * sin(to.lat * dr)
                 + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-                * 6371000;
+                * EARTH_RADIUS;
+        }
+
+        size_t TrigTerms::size() const {
+            return sin_lat.size();
+        }
+
+        void TrigTerms::Add(Coordinates coordinates) {
+            static const double dr = M_PI / 180.;
+            sin_lat.push_back(std::sin(coordinates.lat * dr));
+            cos_lat.push_back(std::cos(coordinates.lat * dr));
+            sin_lng.push_back(std::sin(coordinates.lng * dr));
+            cos_lng.push_back(std::cos(coordinates.lng * dr));
+        }
+
+        namespace {
+
+            /// <summary>
+            /// Cosine of the central angle between the points a and b of terms.
+            /// </summary>
+            double CosCentralAngle(const TrigTerms& terms, uint32_t a, uint32_t b) {
+                const double cos_lng = terms.cos_lng[a] * terms.cos_lng[b] + terms.sin_lng[a] * terms.sin_lng[b];
+                return terms.sin_lat[a] * terms.sin_lat[b] + terms.cos_lat[a] * terms.cos_lat[b] * cos_lng;
+            }
+
+        }
+
+        double ComputeDistance(const TrigTerms& terms, uint32_t from, uint32_t to) {
+            if (from == to) {
+                return 0;
+            }
+            return std::acos(std::min(1.0, CosCentralAngle(terms, from, to))) * EARTH_RADIUS;
+        }
+
+        void ComputeDistances(const TrigTerms& terms, const uint32_t* from, const uint32_t* to, size_t count, double* distances) {
+            size_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+            for (; i + 4 <= count; i += 4) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + i));
+                const __m256d cos_lng = _mm256_fmadd_pd(_mm256_i32gather_pd(terms.cos_lng.data(), a, 8), _mm256_i32gather_pd(terms.cos_lng.data(), b, 8),
+                    _mm256_mul_pd(_mm256_i32gather_pd(terms.sin_lng.data(), a, 8), _mm256_i32gather_pd(terms.sin_lng.data(), b, 8)));
+                const __m256d cos_lat = _mm256_mul_pd(_mm256_i32gather_pd(terms.cos_lat.data(), a, 8), _mm256_i32gather_pd(terms.cos_lat.data(), b, 8));
+                __m256d cos_angle = _mm256_fmadd_pd(cos_lat, cos_lng,
+                    _mm256_mul_pd(_mm256_i32gather_pd(terms.sin_lat.data(), a, 8), _mm256_i32gather_pd(terms.sin_lat.data(), b, 8)));
+                //rounding may go past 1 for (nearly) the same point
+                cos_angle = _mm256_min_pd(cos_angle, _mm256_set1_pd(1.0));
+                alignas(32) double lanes[4];
+                _mm256_store_pd(lanes, cos_angle);
+                for (size_t k = 0; k < 4; ++k) {
+                    distances[i + k] = from[i + k] == to[i + k] ? 0 : std::acos(lanes[k]) * EARTH_RADIUS;
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                distances[i] = ComputeDistance(terms, from[i], to[i]);
+            }
         }
 
         bool IsZero(double value) {
@@ -32,15 +32,21 @@ namespace graph {
         size_t GetEdgeCount() const;
         const Edge<Weight>& GetEdge(EdgeId edge_id) const;
         IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+        /// <summary>
+        /// Edges ending at the vertex (reverse incidence list), for backward searches.
+        /// </summary>
+        IncidentEdgesRange GetIncomingEdges(VertexId vertex) const;
 
     private:
         std::vector<Edge<Weight>> edges_;
         std::vector<IncidenceList> incidence_lists_;
+        std::vector<IncidenceList> incoming_lists_;
     };
 
     template <typename Weight>
     DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-        : incidence_lists_(vertex_count) {
+        : incidence_lists_(vertex_count)
+        , incoming_lists_(vertex_count) {
     }
 
     template <typename Weight>
@@ -48,6 +54,7 @@ namespace graph {
         edges_.push_back(edge);
         const EdgeId id = edges_.size() - 1;
         incidence_lists_.at(edge.from).push_back(id);
+        incoming_lists_.at(edge.to).push_back(id);
         return id;
     }
 
@@ -71,4 +78,10 @@ namespace graph {
         DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
         return ranges::AsRange(incidence_lists_.at(vertex));
     }
+
+    template <typename Weight>
+    typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
+        DirectedWeightedGraph<Weight>::GetIncomingEdges(VertexId vertex) const {
+        return ranges::AsRange(incoming_lists_.at(vertex));
+    }
 }  // namespace graph
\ No newline at end of file
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "graph.h"
+#include "radix_heap.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    /// <summary>
+    /// One entry of a hub label: the distance between a vertex and a hub.
+    /// </summary>
+    template <typename Weight>
+    struct HubLabel {
+        //rank of the hub: the labels of a vertex are sorted by it
+        uint32_t hub;
+        Weight distance;
+        //edge of the vertex on the route between the vertex and the hub, NO_EDGE at the hub itself
+        uint32_t edge;
+    };
+
+    /// <summary>
+    /// Labels of all vertexes in two flat arrays: the labels of vertex v are
+    /// [offsets[v], offsets[v + 1]). Out labels hold distances vertex => hub,
+    /// in labels distances hub => vertex.
+    /// </summary>
+    template <typename Weight>
+    struct HubLabelStorage {
+        std::vector<uint32_t> out_offsets;
+        std::vector<HubLabel<Weight>> out_labels;
+        std::vector<uint32_t> in_offsets;
+        std::vector<HubLabel<Weight>> in_labels;
+
+        bool IsEmpty() const {
+            return out_offsets.empty();
+        }
+    };
+
+    /// <summary>
+    /// Hub labeling of a DirectedWeightedGraph (pruned landmark labeling).
+    /// Every route from -> to passes through a hub in both the out label of from and the
+    /// in label of to, so a distance is a merge of two sorted arrays: no search at query time.
+    /// Vertexes are taken as hubs by decreasing degree; the search from a hub is pruned at the
+    /// vertexes whose distance is already given by the labels of the previous hubs.
+    /// Each label entry keeps the first edge towards its hub, so routes can be unpacked.
+    /// </summary>
+    template <typename Weight>
+    class HubLabels {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+        using Label = HubLabel<Weight>;
+
+    public:
+        using RouteInfo = typename Router<Weight>::RouteInfo;
+
+        static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+        /// <summary>
+        /// Compute the labels of the graph.
+        /// </summary>
+        explicit HubLabels(const Graph& graph);
+
+        /// <summary>
+        /// Restore labels computed before for the same graph.
+        /// Throws std::invalid_argument if they do not match the graph.
+        /// </summary>
+        HubLabels(const Graph& graph, HubLabelStorage<Weight> storage);
+
+        /// <summary>
+        /// Shortest distance from -> to, std::nullopt if there is no route.
+        /// </summary>
+        std::optional<Weight> GetDistance(VertexId from, VertexId to) const;
+
+        /// <summary>
+        /// Edges of a shortest route from -> to, unpacked from the labels, as Router::BuildRoute.
+        /// </summary>
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+        const HubLabelStorage<Weight>& GetStorage() const;
+
+    private:
+        struct LabelRange {
+            const Label* begin;
+            const Label* end;
+        };
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr Weight UNREACHABLE = std::numeric_limits<Weight>::has_infinity
+            ? std::numeric_limits<Weight>::infinity()
+            : std::numeric_limits<Weight>::max();
+
+        LabelRange GetOutLabels(VertexId vertex) const;
+
+        LabelRange GetInLabels(VertexId vertex) const;
+
+        /// <summary>
+        /// Common hub of the out label of from and the in label of to with the shortest route.
+        /// </summary>
+        std::optional<std::pair<const Label*, const Label*>> FindBestHub(VertexId from, VertexId to) const;
+
+        static const Label& FindLabel(LabelRange labels, uint32_t hub);
+
+        /// <summary>
+        /// Pruned search from the hub of the given rank. FORWARD fills the in labels, BACKWARD the out labels.
+        /// </summary>
+        void AddHub(uint32_t rank, VertexId hub, SearchDirection direction,
+            std::vector<std::vector<Label>>& out_labels, std::vector<std::vector<Label>>& in_labels);
+
+        const Graph& graph_;
+        HubLabelStorage<Weight> storage_;
+
+        //scratch of the construction
+        std::vector<Weight> distances_;
+        std::vector<uint32_t> prev_edges_;
+        std::vector<bool> settled_;
+        std::vector<VertexId> touched_;
+        //distances between the current hub and the hubs of its own label, by rank
+        std::vector<Weight> hub_distances_;
+    };
+
+    template <typename Weight>
+    HubLabels<Weight>::HubLabels(const Graph& graph)
+        : graph_(graph) {
+        const size_t vertex_count = graph.GetVertexCount();
+        if (vertex_count >= std::numeric_limits<uint32_t>::max() || graph.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Graph is too large for hub labels");
+        }
+
+        //hubs by decreasing degree
+        std::vector<VertexId> order(vertex_count);
+        std::iota(order.begin(), order.end(), 0);
+        auto degree = [&graph](VertexId vertex) {
+            const auto out = graph.GetIncidentEdges(vertex);
+            const auto in = graph.GetIncomingEdges(vertex);
+            return (out.end() - out.begin()) + (in.end() - in.begin());
+        };
+        std::stable_sort(order.begin(), order.end(), [&degree](VertexId lhs, VertexId rhs) {
+            return degree(lhs) > degree(rhs);
+        });
+
+        distances_.assign(vertex_count, UNREACHABLE);
+        prev_edges_.assign(vertex_count, NO_EDGE);
+        settled_.assign(vertex_count, false);
+        hub_distances_.assign(vertex_count, UNREACHABLE);
+
+        std::vector<std::vector<Label>> out_labels(vertex_count);
+        std::vector<std::vector<Label>> in_labels(vertex_count);
+        for (uint32_t rank = 0; rank < vertex_count; ++rank) {
+            AddHub(rank, order[rank], SearchDirection::FORWARD, out_labels, in_labels);
+            AddHub(rank, order[rank], SearchDirection::BACKWARD, out_labels, in_labels);
+        }
+
+        auto flatten = [vertex_count](std::vector<std::vector<Label>>& labels,
+            std::vector<uint32_t>& offsets, std::vector<Label>& flat) {
+            offsets.reserve(vertex_count + 1);
+            offsets.push_back(0);
+            for (auto& vertex_labels : labels) {
+                flat.insert(flat.end(), vertex_labels.begin(), vertex_labels.end());
+                vertex_labels = {};
+                if (flat.size() >= std::numeric_limits<uint32_t>::max()) {
+                    throw std::length_error("Too many hub labels");
+                }
+                offsets.push_back(static_cast<uint32_t>(flat.size()));
+            }
+        };
+        flatten(out_labels, storage_.out_offsets, storage_.out_labels);
+        flatten(in_labels, storage_.in_offsets, storage_.in_labels);
+
+        //only needed while computing
+        distances_ = {};
+        prev_edges_ = {};
+        settled_ = {};
+        touched_ = {};
+        hub_distances_ = {};
+    }
+
+    template <typename Weight>
+    HubLabels<Weight>::HubLabels(const Graph& graph, HubLabelStorage<Weight> storage)
+        : graph_(graph)
+        , storage_(std::move(storage)) {
+        const size_t vertex_count = graph.GetVertexCount();
+        auto check = [&](const std::vector<uint32_t>& offsets, const std::vector<Label>& labels) {
+            if (offsets.size() != vertex_count + 1 || offsets.front() != 0 || offsets.back() != labels.size()) {
+                return false;
+            }
+            for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+                if (offsets[vertex] > offsets[vertex + 1]) {
+                    return false;
+                }
+                for (uint32_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+                    if (labels[i].hub >= vertex_count || (i > offsets[vertex] && labels[i - 1].hub >= labels[i].hub)
+                        || (labels[i].edge != NO_EDGE && labels[i].edge >= graph.GetEdgeCount())) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        };
+        if (!check(storage_.out_offsets, storage_.out_labels) || !check(storage_.in_offsets, storage_.in_labels)) {
+            throw std::invalid_argument("Hub labels do not match the graph");
+        }
+    }
+
+    template <typename Weight>
+    void HubLabels<Weight>::AddHub(uint32_t rank, VertexId hub, SearchDirection direction,
+        std::vector<std::vector<Label>>& out_labels, std::vector<std::vector<Label>>& in_labels) {
+        const bool forward = direction == SearchDirection::FORWARD;
+        //FORWARD: routes hub => vertex, answered by out label of hub + in label of vertex
+        std::vector<std::vector<Label>>& filled = forward ? in_labels : out_labels;
+        for (const Label& label : forward ? out_labels[hub] : in_labels[hub]) {
+            hub_distances_[label.hub] = label.distance;
+        }
+
+        SearchQueue<Weight> queue;
+        distances_[hub] = ZERO_WEIGHT;
+        touched_.push_back(hub);
+        queue.push({ ZERO_WEIGHT, hub });
+        while (!queue.empty()) {
+            const auto [distance, vertex] = queue.top();
+            queue.pop();
+            if (settled_[vertex] || distances_[vertex] < distance) {
+                //outdated queue item
+                continue;
+            }
+            settled_[vertex] = true;
+
+            //pruned: the labels of the previous hubs already give this distance
+            bool pruned = false;
+            for (const Label& label : filled[vertex]) {
+                if (hub_distances_[label.hub] != UNREACHABLE && !(distance < hub_distances_[label.hub] + label.distance)) {
+                    pruned = true;
+                    break;
+                }
+            }
+            if (pruned) {
+                continue;
+            }
+            filled[vertex].push_back({ rank, distance, prev_edges_[vertex] });
+
+            for (const EdgeId edge_id : forward ? graph_.GetIncidentEdges(vertex) : graph_.GetIncomingEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const VertexId next = forward ? edge.to : edge.from;
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                if (settled_[next]) {
+                    continue;
+                }
+                const Weight candidate = distance + edge.weight;
+                if (distances_[next] == UNREACHABLE || candidate < distances_[next]) {
+                    if (distances_[next] == UNREACHABLE) {
+                        touched_.push_back(next);
+                    }
+                    distances_[next] = candidate;
+                    prev_edges_[next] = static_cast<uint32_t>(edge_id);
+                    queue.push({ candidate, next });
+                }
+            }
+        }
+
+        for (const VertexId vertex : touched_) {
+            distances_[vertex] = UNREACHABLE;
+            prev_edges_[vertex] = NO_EDGE;
+            settled_[vertex] = false;
+        }
+        touched_.clear();
+        for (const Label& label : forward ? out_labels[hub] : in_labels[hub]) {
+            hub_distances_[label.hub] = UNREACHABLE;
+        }
+    }
+
+    template <typename Weight>
+    typename HubLabels<Weight>::LabelRange HubLabels<Weight>::GetOutLabels(VertexId vertex) const {
+        const Label* labels = storage_.out_labels.data();
+        return { labels + storage_.out_offsets.at(vertex), labels + storage_.out_offsets.at(vertex + 1) };
+    }
+
+    template <typename Weight>
+    typename HubLabels<Weight>::LabelRange HubLabels<Weight>::GetInLabels(VertexId vertex) const {
+        const Label* labels = storage_.in_labels.data();
+        return { labels + storage_.in_offsets.at(vertex), labels + storage_.in_offsets.at(vertex + 1) };
+    }
+
+    template <typename Weight>
+    std::optional<std::pair<const HubLabel<Weight>*, const HubLabel<Weight>*>> HubLabels<Weight>::FindBestHub(VertexId from,
+        VertexId to) const {
+        if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex is out of the graph");
+        }
+        std::optional<std::pair<const Label*, const Label*>> best;
+        const LabelRange out = GetOutLabels(from);
+        const LabelRange in = GetInLabels(to);
+        //merge of two arrays sorted by hub
+        for (const Label *out_it = out.begin, *in_it = in.begin; out_it != out.end && in_it != in.end; ) {
+            if (out_it->hub < in_it->hub) {
+                ++out_it;
+            }
+            else if (in_it->hub < out_it->hub) {
+                ++in_it;
+            }
+            else {
+                if (!best || out_it->distance + in_it->distance < best->first->distance + best->second->distance) {
+                    best = std::pair{ out_it, in_it };
+                }
+                ++out_it;
+                ++in_it;
+            }
+        }
+        return best;
+    }
+
+    template <typename Weight>
+    const HubLabel<Weight>& HubLabels<Weight>::FindLabel(LabelRange labels, uint32_t hub) {
+        const Label* found = std::lower_bound(labels.begin, labels.end, hub,
+            [](const Label& label, uint32_t value) { return label.hub < value; });
+        if (found == labels.end || found->hub != hub) {
+            throw std::logic_error("Hub label is missing on the route");
+        }
+        return *found;
+    }
+
+    template <typename Weight>
+    std::optional<Weight> HubLabels<Weight>::GetDistance(VertexId from, VertexId to) const {
+        const auto best = FindBestHub(from, to);
+        if (!best) {
+            return std::nullopt;
+        }
+        return best->first->distance + best->second->distance;
+    }
+
+    template <typename Weight>
+    std::optional<typename HubLabels<Weight>::RouteInfo> HubLabels<Weight>::BuildRoute(VertexId from, VertexId to) const {
+        const auto best = FindBestHub(from, to);
+        if (!best) {
+            return std::nullopt;
+        }
+        const uint32_t hub = best->first->hub;
+        std::vector<EdgeId> edges;
+        //from => hub: every out label points to the next vertex
+        for (const Label* label = best->first; label->edge != NO_EDGE; ) {
+            edges.push_back(label->edge);
+            label = &FindLabel(GetOutLabels(graph_.GetEdge(label->edge).to), hub);
+        }
+        //hub => to: every in label points to the previous vertex
+        const size_t to_hub = edges.size();
+        for (const Label* label = best->second; label->edge != NO_EDGE; ) {
+            edges.push_back(label->edge);
+            label = &FindLabel(GetInLabels(graph_.GetEdge(label->edge).from), hub);
+        }
+        std::reverse(edges.begin() + to_hub, edges.end());
+        return RouteInfo{ best->first->distance + best->second->distance, std::move(edges) };
+    }
+
+    template <typename Weight>
+    const HubLabelStorage<Weight>& HubLabels<Weight>::GetStorage() const {
+        return storage_;
+    }
+
+}  // namespace graph
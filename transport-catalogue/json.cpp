@@ -238,15 +238,26 @@ namespace json {
             std::ostream& out;
             int indent_step = 4;
             int indent = 0;
+            // single line output without indents
+            bool compact = false;
 
             void PrintIndent() const {
+                if (compact) {
+                    return;
+                }
                 for (int i = 0; i < indent; ++i) {
                     out.put(' ');
                 }
             }
 
+            void PrintNewLine() const {
+                if (!compact) {
+                    out.put('\n');
+                }
+            }
+
             PrintContext Indented() const {
-                return { out, indent_step, indent_step + indent };
+                return { out, indent_step, indent_step + indent, compact };
             }
         };
 
@@ -303,7 +314,8 @@ namespace json {
         template <>
         void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
             std::ostream& out = ctx.out;
-            out << "[\n"sv;
+            out.put('[');
+            ctx.PrintNewLine();
             bool first = true;
             auto inner_ctx = ctx.Indented();
             for (const Node& node : nodes) {
@@ -311,12 +323,13 @@ namespace json {
                     first = false;
                 }
                 else {
-                    out << ",\n"sv;
+                    out.put(',');
+                    ctx.PrintNewLine();
                 }
                 inner_ctx.PrintIndent();
                 PrintNode(node, inner_ctx);
             }
-            out.put('\n');
+            ctx.PrintNewLine();
             ctx.PrintIndent();
             out.put(']');
         }
@@ -324,7 +337,8 @@ namespace json {
         template <>
         void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
             std::ostream& out = ctx.out;
-            out << "{\n"sv;
+            out.put('{');
+            ctx.PrintNewLine();
             bool first = true;
             auto inner_ctx = ctx.Indented();
             for (const auto& [key, node] : nodes) {
@@ -332,14 +346,15 @@ namespace json {
                     first = false;
                 }
                 else {
-                    out << ",\n"sv;
+                    out.put(',');
+                    ctx.PrintNewLine();
                 }
                 inner_ctx.PrintIndent();
                 PrintString(key, ctx.out);
-                out << ": "sv;
+                out << (ctx.compact ? ":"sv : ": "sv);
                 PrintNode(node, inner_ctx);
             }
-            out.put('\n');
+            ctx.PrintNewLine();
             ctx.PrintIndent();
             out.put('}');
         }
@@ -374,4 +389,10 @@ namespace json {
         return out.str();
     }
 
+    std::string PrintCompact(const Node& node) {
+        std::ostringstream out;
+        PrintNode(node, PrintContext{ out, 0, 0, true });
+        return out.str();
+    }
+
 }  // namespace json
\ No newline at end of file
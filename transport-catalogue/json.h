@@ -143,4 +143,7 @@ namespace json {
 
     std::string Print(const Node& node);
 
+    // Print node on a single line, without indents
+    std::string PrintCompact(const Node& node);
+
 }  // namespace json
\ No newline at end of file
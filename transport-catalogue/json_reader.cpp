@@ -1,7 +1,10 @@
 #include "json_reader.h"
 #include "json_builder.h"
 #include "serialization.h"
+#include "server.h"
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <sstream>
 #include <filesystem>
 
@@ -23,7 +26,6 @@ namespace catalogue {
 	std::vector<input::BusInputData> GetBusRequestsFromJSON(json::Node node) {
 		json::Array data = node.AsArray();
 		std::vector<input::BusInputData> result;
-		std::string end_stop;
 		for (auto elem : data) {
 			json::Dict dic = elem.AsDict();
 
@@ -32,30 +34,18 @@ namespace catalogue {
 				std::vector<std::string> stops;
 				std::vector<json::Node> stops_raw = dic.at("stops").AsArray();
 				bool is_circular = dic.at("is_roundtrip").AsBool();
-				if (is_circular) {
-					end_stop = stops_raw[0].AsString();
-					for (auto stp : stops_raw) {
-						stops.push_back(stp.AsString());
-					}
+				//a straight line is stored one way
+				for (auto stp : stops_raw) {
+					stops.push_back(stp.AsString());
 				}
-				else {
-					end_stop = stops_raw[stops_raw.size()-1].AsString();
-					for (auto stp : stops_raw) {
-						stops.push_back(stp.AsString());
-					}
 
-					int q = (int)(stops.size() - 2);
-					{
-						while (q >= 0) {
-							std::string stp = stops[q];
-							stops.push_back(stp);
-							--q;
-						}
+				input::BusInputData info{ name, stops, is_circular ? RouteKind::ROUND_TRIP : RouteKind::STRAIGHT };
+				//optional timetable
+				if (dic.count("departures") > 0) {
+					for (const auto& departure : dic.at("departures").AsArray()) {
+						info.departures.push_back(ClockTimeFromNode(departure));
 					}
-
 				}
-
-				input::BusInputData info{ name, stops ,end_stop };
 				result.push_back(info);
 			}
 		}
@@ -106,6 +96,76 @@ namespace catalogue {
 			}
 			else if (dic.at("type").AsString() == "Route") {
 				input::JsonOutputRequest output{ dic.at("id").AsInt(), input::OutputType::ROUTE , ""s , dic.at("from").AsString(), dic.at("to").AsString() };
+				//optional: same keys as in routing_settings
+				if (dic.count("bus_velocity") > 0) {
+					output.routing_override.velocity = dic.at("bus_velocity").AsDouble();
+				}
+				if (dic.count("bus_wait_time") > 0) {
+					output.routing_override.wait_time = dic.at("bus_wait_time").AsDouble();
+				}
+				result.push_back(output);
+			}
+			else if (dic.at("type").AsString() == "RouteCacheStats") {
+				input::JsonOutputRequest output{ dic.at("id").AsInt(), input::OutputType::ROUTE_CACHE_STATS , ""s , ""s, ""s };
+				result.push_back(output);
+			}
+			else if (dic.at("type").AsString() == "Reachable") {
+				input::JsonOutputRequest output{ dic.at("id").AsInt(), input::OutputType::REACHABLE , ""s , dic.at("from").AsString(), ""s };
+				output.time_budget = dic.at("time").AsDouble();
+				result.push_back(output);
+			}
+			else if (dic.at("type").AsString() == "NearestStops") {
+				input::JsonOutputRequest output{ dic.at("id").AsInt(), input::OutputType::NEAREST_STOPS , ""s , ""s, ""s };
+				output.location = { dic.at("latitude").AsDouble(), dic.at("longitude").AsDouble() };
+				if (dic.count("count") == 0 && dic.count("radius") == 0) {
+					throw std::invalid_argument("NearestStops needs count or radius");
+				}
+				if (dic.count("count") > 0) {
+					if (dic.at("count").AsInt() < 0) {
+						throw std::invalid_argument("NearestStops count should be non-negative");
+					}
+					output.count = dic.at("count").AsInt();
+				}
+				if (dic.count("radius") > 0) {
+					output.radius = dic.at("radius").AsDouble();
+				}
+				result.push_back(output);
+			}
+			else if (dic.at("type").AsString() == "RouteFromPoint") {
+				input::JsonOutputRequest output{ dic.at("id").AsInt(), input::OutputType::ROUTE_FROM_POINT , ""s , ""s, ""s };
+				const json::Dict& from = dic.at("from").AsDict();
+				const json::Dict& to = dic.at("to").AsDict();
+				output.location = { from.at("latitude").AsDouble(), from.at("longitude").AsDouble() };
+				output.destination = { to.at("latitude").AsDouble(), to.at("longitude").AsDouble() };
+				result.push_back(output);
+			}
+			else if (dic.at("type").AsString() == "TravelTime") {
+				input::JsonOutputRequest output{ dic.at("id").AsInt(), input::OutputType::TRAVEL_TIME , ""s , dic.at("from").AsString(), dic.at("to").AsString() };
+				//optional: unpack the route items too
+				if (dic.count("items") > 0) {
+					output.with_items = dic.at("items").AsBool();
+				}
+				result.push_back(output);
+			}
+			else if (dic.at("type").AsString() == "TimetableRoute") {
+				input::JsonOutputRequest output{ dic.at("id").AsInt(), input::OutputType::TIMETABLE_ROUTE , ""s , dic.at("from").AsString(), dic.at("to").AsString() };
+				output.departure_time = ClockTimeFromNode(dic.at("departure_time"));
+				result.push_back(output);
+			}
+			else if (dic.at("type").AsString() == "Profile") {
+				input::JsonOutputRequest output{ dic.at("id").AsInt(), input::OutputType::PROFILE , ""s , dic.at("from").AsString(), dic.at("to").AsString() };
+				output.departure_time = ClockTimeFromNode(dic.at("from_time"));
+				output.window_end = ClockTimeFromNode(dic.at("to_time"));
+				result.push_back(output);
+			}
+			else if (dic.at("type").AsString() == "Matrix") {
+				input::JsonOutputRequest output{ dic.at("id").AsInt(), input::OutputType::MATRIX , ""s , ""s, ""s };
+				for (const auto& stop : dic.at("from").AsArray()) {
+					output.from_stops.push_back(stop.AsString());
+				}
+				for (const auto& stop : dic.at("to").AsArray()) {
+					output.to_stops.push_back(stop.AsString());
+				}
 				result.push_back(output);
 			}
 
@@ -123,7 +183,71 @@ namespace catalogue {
 	RoutingSettings GetRoutingSettings(json::Node settings) {
 		double velocity = settings.AsDict().at("bus_velocity").AsDouble();
 		double wait_time = settings.AsDict().at("bus_wait_time").AsInt();
-		return { velocity ,wait_time };
+		RoutingSettings routing{ velocity ,wait_time };
+		//optional: "stop_pairs" (default) or "ride_vertices"
+		const auto graph_model = settings.AsDict().find("graph_model");
+		if (graph_model != settings.AsDict().end()) {
+			if (graph_model->second.AsString() == "ride_vertices") {
+				routing.graph_model = GraphModel::RIDE_VERTICES;
+			}
+			else if (graph_model->second.AsString() != "stop_pairs") {
+				throw std::invalid_argument("Unknown graph_model: " + graph_model->second.AsString());
+			}
+		}
+		if (settings.AsDict().count("walk_velocity") > 0) {
+			routing.walk_velocity = settings.AsDict().at("walk_velocity").AsDouble();
+			if (routing.walk_velocity <= 0) {
+				throw std::invalid_argument("walk_velocity should be positive");
+			}
+		}
+		if (settings.AsDict().count("walk_radius") > 0) {
+			routing.walk_radius = settings.AsDict().at("walk_radius").AsDouble();
+		}
+
+		//optional: "all_pairs" (default) or "per_query"
+		const auto mode = settings.AsDict().find("router");
+		if (mode != settings.AsDict().end()) {
+			if (mode->second.AsString() == "per_query") {
+				routing.mode = RouterMode::PER_QUERY;
+			}
+			else if (mode->second.AsString() != "all_pairs") {
+				throw std::invalid_argument("Unknown router: " + mode->second.AsString());
+			}
+		}
+		if (settings.AsDict().count("hub_labels") > 0) {
+			routing.hub_labels = settings.AsDict().at("hub_labels").AsBool();
+		}
+		//optional: "floyd_warshall" (default) or "dijkstra"
+		const auto all_pairs = settings.AsDict().find("all_pairs");
+		if (all_pairs != settings.AsDict().end()) {
+			if (all_pairs->second.AsString() == "dijkstra") {
+				routing.all_pairs_algorithm = graph::AllPairsAlgorithm::DIJKSTRA;
+			}
+			else if (all_pairs->second.AsString() != "floyd_warshall") {
+				throw std::invalid_argument("Unknown all_pairs: " + all_pairs->second.AsString());
+			}
+		}
+		//optional: "raptor" (default) or "connection_scan"
+		const auto timetable_engine = settings.AsDict().find("timetable_engine");
+		if (timetable_engine != settings.AsDict().end()) {
+			if (timetable_engine->second.AsString() == "connection_scan") {
+				routing.timetable_engine = TimetableEngine::CONNECTION_SCAN;
+			}
+			else if (timetable_engine->second.AsString() != "raptor") {
+				throw std::invalid_argument("Unknown timetable_engine: " + timetable_engine->second.AsString());
+			}
+		}
+		//optional: "alphabetical" (default) or "hilbert"
+		const auto vertex_order = settings.AsDict().find("vertex_order");
+		if (vertex_order != settings.AsDict().end()) {
+			if (vertex_order->second.AsString() == "hilbert") {
+				routing.vertex_order = VertexOrder::HILBERT;
+			}
+			else if (vertex_order->second.AsString() != "alphabetical") {
+				throw std::invalid_argument("Unknown vertex_order: " + vertex_order->second.AsString());
+			}
+		}
+		return routing;
 	}
 	
 
@@ -181,12 +305,12 @@ namespace catalogue {
 	}
 
 
-	json::Array RouteItemsToNode(std::vector<std::variant<WaitItem, BusItem>> input) {
+	json::Array RouteItemsToNode(const std::vector<RouteItem>& input) {
 		using namespace std::literals;
 		json::Array items;
-		for (const auto elem : input) {
+		for (const auto& elem : input) {
 			if (std::holds_alternative<WaitItem>(elem)) {
-				WaitItem val = std::get<WaitItem>(elem);
+				const WaitItem& val = std::get<WaitItem>(elem);
 				items.push_back(json::Builder{}
 					.StartDict()
 					.Key("stop_name"s).Value(val.stop_name)
@@ -195,7 +319,7 @@ namespace catalogue {
 					.EndDict().Build());
 			}
 			else if (std::holds_alternative<BusItem>(elem)) {
-				BusItem val = std::get<BusItem>(elem);
+				const BusItem& val = std::get<BusItem>(elem);
 				items.push_back(json::Builder{}
 					.StartDict()
 					.Key("bus"s).Value(val.bus_name)
@@ -204,6 +328,22 @@ namespace catalogue {
 					.Key("type"s).Value("Bus"s)
 					.EndDict().Build());
 			}
+			else if (std::holds_alternative<WalkItem>(elem)) {
+				const WalkItem& val = std::get<WalkItem>(elem);
+				json::Builder item;
+				item.StartDict();
+				if (!val.from_stop.empty()) {
+					item.Key("from"s).Value(val.from_stop);
+				}
+				if (!val.to_stop.empty()) {
+					item.Key("to"s).Value(val.to_stop);
+				}
+				items.push_back(item
+					.Key("distance"s).Value(val.distance)
+					.Key("time"s).Value(val.time)
+					.Key("type"s).Value("Walk"s)
+					.EndDict().Build());
+			}
 		}
 		return items;
 	}
@@ -227,6 +367,123 @@ namespace catalogue {
 						.EndDict().Build();
 	}
 
+	json::Node TravelTimeToNode(const TransportRouteInfo& route_info, bool with_items, int index) {
+		using namespace std::literals;
+		if (with_items || !route_info.rout_exists) {
+			return RouteToNode(route_info, index);
+		}
+		return json::Builder{}
+						.StartDict()
+						.Key("request_id"s).Value(index)
+						.Key("total_time"s).Value(route_info.total_time)
+						.EndDict().Build();
+	}
+
+	json::Node TimetableRouteToNode(const TransportRouteInfo& route_info, double departure_time, int index) {
+		using namespace std::literals;
+		if (!route_info.rout_exists) {
+			return RouteToNode(route_info, index);
+		}
+		return json::Builder{}
+						.StartDict()
+						.Key("request_id"s).Value(index)
+						.Key("total_time"s).Value(route_info.total_time)
+						.Key("arrival_time"s).Value(departure_time + route_info.total_time)
+						.Key("items"s).Value(RouteItemsToNode(route_info.items))
+						.EndDict().Build();
+	}
+
+	json::Node ProfileToNode(const std::vector<ProfileEntry>& profile, int index) {
+		using namespace std::literals;
+		json::Array departures;
+		for (const ProfileEntry& entry : profile) {
+			departures.push_back(json::Builder{}
+				.StartDict()
+				.Key("departure_time"s).Value(entry.departure_time)
+				.Key("arrival_time"s).Value(entry.arrival_time)
+				.EndDict().Build());
+		}
+		return json::Builder{}
+						.StartDict()
+						.Key("request_id"s).Value(index)
+						.Key("departures"s).Value(departures)
+						.EndDict().Build();
+	}
+
+	namespace {
+
+		/// <summary>
+		/// JSON has int only: a counter of a long-running server stops at INT_MAX instead of going negative.
+		/// </summary>
+		int ClampCounter(size_t counter) {
+			return static_cast<int>(std::min<size_t>(counter, std::numeric_limits<int>::max()));
+		}
+
+	}
+
+	json::Node CacheStatsToNode(const cache::CacheStats& stats, int index) {
+		using namespace std::literals;
+		return json::Builder{}
+						.StartDict()
+						.Key("request_id"s).Value(index)
+						.Key("hits"s).Value(ClampCounter(stats.hits))
+						.Key("misses"s).Value(ClampCounter(stats.misses))
+						.Key("size"s).Value(ClampCounter(stats.size))
+						.Key("capacity"s).Value(ClampCounter(stats.capacity))
+						.EndDict().Build();
+	}
+
+	json::Node MatrixToNode(const std::vector<std::vector<std::optional<double>>>& times, int index) {
+		using namespace std::literals;
+		json::Array rows;
+		for (const auto& row : times) {
+			json::Array cells;
+			for (const auto& time : row) {
+				cells.push_back(time ? json::Node(*time) : json::Node(nullptr));
+			}
+			rows.push_back(std::move(cells));
+		}
+		return json::Builder{}
+						.StartDict()
+						.Key("request_id"s).Value(index)
+						.Key("total_times"s).Value(std::move(rows))
+						.EndDict().Build();
+	}
+
+	json::Node ReachableToNode(const std::vector<std::pair<Stop*, double>>& stops, int index) {
+		using namespace std::literals;
+		json::Array items;
+		for (const auto& [stop, time] : stops) {
+			items.push_back(json::Builder{}
+				.StartDict()
+				.Key("stop_name"s).Value(stop->stop_name)
+				.Key("time"s).Value(time)
+				.EndDict().Build());
+		}
+		return json::Builder{}
+						.StartDict()
+						.Key("request_id"s).Value(index)
+						.Key("items"s).Value(std::move(items))
+						.EndDict().Build();
+	}
+
+	json::Node NearestStopsToNode(const std::vector<std::pair<const Stop*, double>>& stops, int index) {
+		using namespace std::literals;
+		json::Array items;
+		for (const auto& [stop, distance] : stops) {
+			items.push_back(json::Builder{}
+				.StartDict()
+				.Key("stop_name"s).Value(stop->stop_name)
+				.Key("distance"s).Value(distance)
+				.EndDict().Build());
+		}
+		return json::Builder{}
+						.StartDict()
+						.Key("request_id"s).Value(index)
+						.Key("items"s).Value(std::move(items))
+						.EndDict().Build();
+	}
+
 	json::Node GetStatRequests(const std::vector<input::JsonOutputRequest>& requests, TransportCatalogue& catalogue) {
 		json::Array result;
 		for (auto r : requests) {
@@ -247,33 +504,71 @@ namespace catalogue {
 
 	json::Node GetStatWithMapRequests(
 		const std::vector<input::JsonOutputRequest>& requests,
-		renderer::NetworkDrawingData drawing_data,
-		TransportCatalogue& catalogue,
-		TransportGraphWrapper& graph_wrapper
+		const RequestHandler& handler
 	) {
-		json::Array result;
-		for (auto r : requests) {
+		//answers are put at the position of their request
+		json::Array result(requests.size());
+		//positions of Route requests by origin stop: one search per distinct origin
+		std::map<std::string, std::vector<size_t>> routes_by_origin;
+
+		for (size_t pos = 0; pos < requests.size(); ++pos) {
+			const auto& r = requests[pos];
 			if (r.type == input::OutputType::BUS) {
-				BusInfo info = catalogue.GetBusInfo(r.name);
-				json::Node node_bus = BusToNode(info, r.index);
-				result.push_back(node_bus);
+				BusInfo info = handler.GetBusInfo(r.name);
+				result[pos] = BusToNode(info, r.index);
 			}
 			else if (r.type == input::OutputType::STOP) {
-				StopInfo info = catalogue.GetStopInfo(r.name);
-				json::Node node_stop = StopToNode(info, r.index);
-				result.push_back(node_stop);
+				StopInfo info = handler.GetStopInfo(r.name);
+				result[pos] = StopToNode(info, r.index);
 			}
 			else if (r.type == input::OutputType::MAP) {
-				std::ostringstream map_streamed;
-				renderer::DrawNetworkMap(map_streamed, drawing_data);
-				json::Node map_node = MapToNode(map_streamed.str(), r.index);
-				result.push_back(map_node);
+				result[pos] = MapToNode(handler.GetMap(), r.index);
+			}
+			else if (r.type == input::OutputType::ROUTE && !r.routing_override.IsEmpty()) {
+				result[pos] = RouteToNode(handler.FindRoute(r.start, r.end, r.routing_override), r.index);
 			}
 			else if (r.type == input::OutputType::ROUTE) {
-				TransportRouteInfo output = graph_wrapper.FindRoute( { catalogue.FindStop(r.start),catalogue.FindStop(r.end) });
-				//here compute with the Router the route
-				json::Node route_node = RouteToNode(output, r.index);
-				result.push_back(route_node);
+				routes_by_origin[r.start].push_back(pos);
+			}
+			else if (r.type == input::OutputType::REACHABLE) {
+				result[pos] = ReachableToNode(handler.GetReachableStops(r.start, r.time_budget), r.index);
+			}
+			else if (r.type == input::OutputType::NEAREST_STOPS) {
+				result[pos] = NearestStopsToNode(handler.GetNearestStops(r.location, r.count, r.radius), r.index);
+			}
+			else if (r.type == input::OutputType::ROUTE_FROM_POINT) {
+				result[pos] = RouteToNode(handler.FindRouteBetweenPoints(r.location, r.destination), r.index);
+			}
+			else if (r.type == input::OutputType::TRAVEL_TIME) {
+				result[pos] = TravelTimeToNode(handler.FindTravelTime(r.start, r.end, r.with_items), r.with_items, r.index);
+			}
+			else if (r.type == input::OutputType::TIMETABLE_ROUTE) {
+				result[pos] = TimetableRouteToNode(handler.FindTimetableRoute(r.start, r.end, r.departure_time), r.departure_time, r.index);
+			}
+			else if (r.type == input::OutputType::PROFILE) {
+				result[pos] = ProfileToNode(handler.FindProfile(r.start, r.end, r.departure_time, r.window_end), r.index);
+			}
+			else if (r.type == input::OutputType::MATRIX) {
+				result[pos] = MatrixToNode(handler.GetTravelTimeMatrix(r.from_stops, r.to_stops), r.index);
+			}
+		}
+
+		for (const auto& [from, positions] : routes_by_origin) {
+			std::vector<std::string> to;
+			for (size_t pos : positions) {
+				to.push_back(requests[pos].end);
+			}
+			//the first Route request builds the graph and the router
+			std::vector<std::shared_ptr<const TransportRouteInfo>> routes = handler.FindRoutesFrom(from, to);
+			for (size_t k = 0; k < positions.size(); ++k) {
+				result[positions[k]] = RouteToNode(*routes[k], requests[positions[k]].index);
+			}
+		}
+
+		//counters include the routes of this batch
+		for (size_t pos = 0; pos < requests.size(); ++pos) {
+			if (requests[pos].type == input::OutputType::ROUTE_CACHE_STATS) {
+				result[pos] = CacheStatsToNode(handler.GetRouteCacheStats(), requests[pos].index);
 			}
 		}
 		return result;
@@ -362,6 +657,22 @@ namespace catalogue {
 		return offset;
 	}
 
+	double ClockTimeFromNode(const json::Node& nd) {
+		if (!nd.IsString()) {
+			return nd.AsDouble();
+		}
+		const std::string& text = nd.AsString();
+		int hours = 0;
+		int minutes = 0;
+		char separator = 0;
+		std::istringstream stream(text);
+		if (!(stream >> hours >> separator >> minutes) || separator != ':' || !stream.eof()
+			|| hours < 0 || minutes < 0 || minutes >= 60) {
+			throw std::invalid_argument("Invalid time (HH:MM expected): " + text);
+		}
+		return hours * 60. + minutes;
+	}
+
 	svg::Color GetColorFromNode(json::Node nd) {
 		if (nd.IsString()) {
 			return svg::Color(nd.AsString());
@@ -407,7 +718,7 @@ namespace catalogue {
 
 		std::vector<Stop*> stopsPtr = catalogue.GetStopsPtrInNetwork();
 
-		return renderer::NetworkDrawingData{ buses,stopsPtr,  params };
+		return renderer::NetworkDrawingData{ buses, renderer::GetStopIds(stopsPtr),  params, &catalogue.GetStopColumns() };
 	}
 
 
@@ -431,18 +742,11 @@ namespace catalogue {
 
 		input::AddBaseRequests(inputs_stops, inputs_bus, catalogue);
 		
-		//construct graph with routing_settings + catalogue
+		//graph with routing_settings + catalogue is built on the first Route request
 		RoutingSettings rt_settings = GetRoutingSettings(routing_settings);
-		std::vector<Bus*> buses = catalogue.GetAllBuses();
-		std::vector<Stop*> stopsPtr = catalogue.GetStopsPtrInNetwork();
-		renderer::NetworkDrawingData drawing_data{ buses,stopsPtr,  params };
-
-		TransportGraphWrapper graph_wrapper(rt_settings, catalogue);
+		RequestHandler handler(catalogue, params, rt_settings);
 
-		graph_wrapper.BuildTransportGraph();
-
-		//complete also the next method GetStatWithMapRequests
-		json::Node output_node = GetStatWithMapRequests(requests, drawing_data, catalogue, graph_wrapper);
+		json::Node output_node = GetStatWithMapRequests(requests, handler);
 		output << Print(output_node);
 
 	}
@@ -471,7 +775,19 @@ namespace catalogue {
 		std::ofstream myfile;
 		myfile.open(storage_path,std::ios::binary);
 
-		serialization::SerializeTransportSystem(catalogue, params, routing, myfile);
+		//hub labels are derived from the routing graph; the all-pairs router is not needed for it
+		graph::HubLabelStorage<GraphTime> hub_labels;
+		if (routing.hub_labels) {
+			RoutingSettings labels_routing = routing;
+			labels_routing.mode = RouterMode::PER_QUERY;
+			TransportGraphWrapper graph_wrapper(labels_routing, catalogue);
+			graph_wrapper.BuildTransportGraph();
+			graph_wrapper.BuildHubLabels();
+			hub_labels = graph_wrapper.GetHubLabels()->GetStorage();
+		}
+
+		//spatial index over the stops is built once here and stored with the base
+		serialization::SerializeTransportSystem(catalogue, params, routing, StopIndex(catalogue.GetStopColumns()), hub_labels, myfile);
 	}
 
 
@@ -490,18 +806,63 @@ namespace catalogue {
 		
 		renderer::RendererParameters params;
 		RoutingSettings routing;
-		TransportCatalogue catalogue = serialization::DeserializeTransportSystem(params, routing ,myfile);
-
-		std::vector<Bus*> buses = catalogue.GetAllBuses();
-		std::vector<Stop*> stopsPtr = catalogue.GetStopsPtrInNetwork();
+		StopIndex stop_index;
+		graph::HubLabelStorage<GraphTime> hub_labels;
+		TransportCatalogue catalogue = serialization::DeserializeTransportSystem(params, routing, stop_index, hub_labels, myfile);
 
-		TransportGraphWrapper graph_wrapper(routing, catalogue);
-		graph_wrapper.BuildTransportGraph();
-		
-		renderer::NetworkDrawingData drawing_data{ buses,stopsPtr,  params };
+		//graph, router and map data are prepared only if a request needs them
+		RequestHandler handler(catalogue, params, routing, std::move(stop_index), std::move(hub_labels));
 
-		json::Node output_node = GetStatWithMapRequests(requests, drawing_data, catalogue, graph_wrapper);
+		json::Node output_node = GetStatWithMapRequests(requests, handler);
 		output << Print(output_node);
 	}
 
-}
\ No newline at end of file
+
+
+	json::Node AnswerStatDocument(const json::Node& document, const RequestHandler& handler) {
+		const json::Dict& dic = document.AsDict();
+		if (dic.count("stat_requests") > 0) {
+			std::vector<input::JsonOutputRequest> requests = GetStatRequestsFromJSON(dic.at("stat_requests"));
+			return GetStatWithMapRequests(requests, handler);
+		}
+		//a single pipelined request
+		std::vector<input::JsonOutputRequest> requests = GetStatRequestsFromJSON(json::Array{ document });
+		json::Array result = GetStatWithMapRequests(requests, handler).AsArray();
+		if (result.empty()) {
+			throw std::invalid_argument("Unknown request type");
+		}
+		return result.front();
+	}
+
+
+	void Serve(const std::string& storage_path, const std::string& socket_path, size_t worker_count,
+		std::istream& input, std::ostream& output) {
+		std::ifstream myfile;
+		myfile.open(storage_path, std::ios::binary);
+		if (!myfile) {
+			throw std::invalid_argument("Cannot open " + storage_path);
+		}
+
+		renderer::RendererParameters params;
+		RoutingSettings routing;
+		StopIndex stop_index;
+		graph::HubLabelStorage<GraphTime> hub_labels;
+		TransportCatalogue catalogue = serialization::DeserializeTransportSystem(params, routing, stop_index, hub_labels, myfile);
+
+		//the base stays resident: router and map are built once and reused by all documents
+		RequestHandler handler(catalogue, params, routing, std::move(stop_index), std::move(hub_labels));
+		//no threads started per request: a matrix is computed by the thread answering its document
+		handler.SetMatrixThreadCount(1);
+		server::DocumentHandler answer = [&handler](const json::Node& document) {
+			return AnswerStatDocument(document, handler);
+		};
+
+		if (socket_path.empty()) {
+			server::ServeStream(input, output, answer);
+		}
+		else {
+			server::ServeUnixSocket(socket_path, answer, worker_count);
+		}
+	}
+
+}
@@ -46,23 +46,60 @@ namespace catalogue {
 	/// <summary>
 	/// Transform a route-times (bus/wait) to std::vector of json::Node.
 	/// </summary>
-	json::Array RouteItemsToNode(std::vector<std::variant<WaitItem, BusItem>> input);
+	json::Array RouteItemsToNode(const std::vector<RouteItem>& input);
 
 	/// <summary>
 	/// transform a RouteInfo object into a json::Node
 	/// </summary>
 	json::Node RouteToNode(const TransportRouteInfo& route_info, int index);
 
+	/// <summary>
+	/// TravelTime answer: total_time only, or the whole route if with_items.
+	/// </summary>
+	json::Node TravelTimeToNode(const TransportRouteInfo& route_info, bool with_items, int index);
 
+	/// <summary>
+	/// TimetableRoute answer: the route with the arrival time (minutes since midnight).
+	/// </summary>
+	json::Node TimetableRouteToNode(const TransportRouteInfo& route_info, double departure_time, int index);
+
+	/// <summary>
+	/// Profile answer: the Pareto-optimal (departure, arrival) trips.
+	/// </summary>
+	json::Node ProfileToNode(const std::vector<ProfileEntry>& profile, int index);
+
+	/// <summary>
+	/// Hit/miss counters of the route cache as a json::Node
+	/// </summary>
+	json::Node CacheStatsToNode(const cache::CacheStats& stats, int index);
+
+
+
+	/// <summary>
+	/// Travel-time matrix: one array per origin, null where there is no route.
+	/// </summary>
+	json::Node MatrixToNode(const std::vector<std::vector<std::optional<double>>>& times, int index);
+
+	/// <summary>
+	/// Reachable stops with their arrival times.
+	/// </summary>
+	json::Node ReachableToNode(const std::vector<std::pair<Stop*, double>>& stops, int index);
+
+	/// <summary>
+	/// Nearest stops with their distances in meters.
+	/// </summary>
+	json::Node NearestStopsToNode(const std::vector<std::pair<const Stop*, double>>& stops, int index);
 
 	json::Node GetStatRequests(const std::vector<input::JsonOutputRequest>& requests ,TransportCatalogue& catalogue);
 
 
+	/// <summary>
+	/// Answer stat requests (Bus/Stop/Map/Route). Router and map are built by the handler
+	/// only if a request needs them.
+	/// </summary>
 	json::Node GetStatWithMapRequests(
 		const std::vector<input::JsonOutputRequest>& requests,
-		renderer::NetworkDrawingData drawing_data,
-		TransportCatalogue& catalogue,
-		TransportGraphWrapper& graph_wrapper);
+		const RequestHandler& handler);
 
 
 	/// <summary>
@@ -72,6 +109,11 @@ namespace catalogue {
 	/// <returns></returns>
 	std::vector<double> GetVectorFromNode(json::Node nd);
 
+	/// <summary>
+	/// Time of day in minutes since midnight: a number of minutes or a "HH:MM" string.
+	/// </summary>
+	double ClockTimeFromNode(const json::Node& nd);
+
 	/// <summary>
 	/// Parse JSON node a svg::Color.
 	/// </summary>
@@ -128,4 +170,21 @@ namespace catalogue {
 	/// <param name="catalogue"></param>
 	void ProcessRequests(std::istream& input, std::ostream& output);
 
+
+	/// <summary>
+	/// Answer one document: either a dict with "stat_requests" (answered with an array, other keys are ignored)
+	/// or a single stat request (answered with a single dict carrying its request_id).
+	/// </summary>
+	json::Node AnswerStatDocument(const json::Node& document, const RequestHandler& handler);
+
+	/// <summary>
+	/// Deserialize the .db file once, then answer documents as they arrive:
+	/// from input (newline- or length-delimited) or, if socket_path is not empty, from a Unix domain socket
+	/// served by an event loop and worker_count threads.
+	/// </summary>
+	/// <param name="storage_path"></param>
+	/// <param name="socket_path"></param>
+	void Serve(const std::string& storage_path, const std::string& socket_path, size_t worker_count,
+		std::istream& input, std::ostream& output);
+
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+    struct CacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    /// <summary>
+    /// Bounded map that evicts the least recently used entry. All methods can be called concurrently.
+    /// Value is returned by copy, so large values are better stored behind a std::shared_ptr.
+    /// </summary>
+    template <typename Key, typename Value, typename Hash = std::hash<Key>>
+    class LruCache {
+    public:
+        explicit LruCache(size_t capacity)
+            : capacity_(capacity) {
+        }
+
+        /// <summary>
+        /// Return the cached value (and mark it as recently used) or std::nullopt.
+        /// </summary>
+        std::optional<Value> Get(const Key& key) {
+            std::lock_guard lock(mutex_);
+            auto it = positions_.find(key);
+            if (it == positions_.end()) {
+                ++misses_;
+                return std::nullopt;
+            }
+            ++hits_;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return it->second->second;
+        }
+
+        void Put(const Key& key, Value value) {
+            if (capacity_ == 0) {
+                return;
+            }
+            std::lock_guard lock(mutex_);
+            auto it = positions_.find(key);
+            if (it != positions_.end()) {
+                it->second->second = std::move(value);
+                entries_.splice(entries_.begin(), entries_, it->second);
+                return;
+            }
+            if (entries_.size() == capacity_) {
+                positions_.erase(entries_.back().first);
+                entries_.pop_back();
+            }
+            entries_.emplace_front(key, std::move(value));
+            positions_[key] = entries_.begin();
+        }
+
+        CacheStats GetStats() const {
+            std::lock_guard lock(mutex_);
+            return { hits_, misses_, entries_.size(), capacity_ };
+        }
+
+    private:
+        using Entry = std::pair<Key, Value>;
+
+        size_t capacity_;
+        //most recently used first
+        std::list<Entry> entries_;
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> positions_;
+        mutable std::mutex mutex_;
+        size_t hits_ = 0;
+        size_t misses_ = 0;
+    };
+
+}  // namespace cache
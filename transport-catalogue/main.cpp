@@ -5,22 +5,38 @@
 #include <string_view>
 #include <sstream>
 #include <filesystem>
+#include <charconv>
+#include <optional>
 #include "transport_catalogue.h"
 #include "request_handler.h"
 #include "testTC.h"
 #include "testNode.h"
 #include "testReadJSON.h"
 #include "testSVG.h"
+#include "testRouting.h"
 #include "json_reader.h"
 #include "svg.h"
 #include "map_renderer.h"
 #include "json_builder.h"
+#include "server.h"
+#include "thread_pool.h"
 
 using namespace catalogue;
 
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|process_requests|serve <db_file> [socket_path [workers]]"
+              "|load_test <socket_path> [connections]]\n"sv;
+}
+
+// a positive count given on the command line, nullopt when it is not a number or is 0
+std::optional<size_t> ParseCount(std::string_view text) {
+    size_t count = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), count);
+    if (error != std::errc() || end != text.data() + text.size() || count == 0) {
+        return std::nullopt;
+    }
+    return count;
 }
 
 void UnitTests() {
@@ -30,6 +46,7 @@ void UnitTests() {
     test::TestFullRequestBus();
     test::TestFullRequestBusAndStop();
     test::TestLoadJSONToTC();
+    test::TestsRouting();
 }
 
 
@@ -38,14 +55,44 @@ int main(int argc, char* argv[])
     //UnitTests();
     
     //input/output
-    if (argc != 2) {
+    if (argc < 2) {
         PrintUsage();
         return 1;
     }
 
     const std::string_view mode(argv[1]);
 
-    if (mode == "make_base"sv) {
+    if (mode == "serve"sv) {
+        if (argc < 3 || argc > 5) {
+            PrintUsage();
+            return 1;
+        }
+        // load base once, then answer stat_requests documents as they arrive
+        const std::optional<size_t> workers = argc == 5 ? ParseCount(argv[4]) : parallel::DefaultThreadCount();
+        if (!workers) {
+            PrintUsage();
+            return 1;
+        }
+        Serve(argv[2], argc >= 4 ? argv[3] : "", *workers, std::cin, std::cout);
+    }
+    else if (mode == "load_test"sv) {
+        if (argc != 3 && argc != 4) {
+            PrintUsage();
+            return 1;
+        }
+        // requests (one per line) from stdin are sent to a running server
+        const std::optional<size_t> connections = argc == 4 ? ParseCount(argv[3]) : 1;
+        if (!connections) {
+            PrintUsage();
+            return 1;
+        }
+        server::RunLoadTest(argv[2], *connections, std::cin, std::cout);
+    }
+    else if (argc != 2) {
+        PrintUsage();
+        return 1;
+    }
+    else if (mode == "make_base"sv) {
         MakeBase(std::cin);
         // make base here
 
@@ -185,28 +185,29 @@ namespace catalogue {
 		//------------------
 
 
-		BusShape GetBusShape(Bus* bus, geo::SphereProjector& proj, svg::Color color , double stroke_width) {
-			std::vector<Stop*> stops = bus->stops;
+		BusShape GetBusShape(Bus* bus, geo::SphereProjector& proj, svg::Color color , double stroke_width, const StopColumns& columns) {
 			std::vector<svg::Point> pts;
-			for (const auto stp : stops) {
+			const RouteView route_stops = bus->GetFullRoute();
+			pts.reserve(route_stops.size());
+			for (const auto stp : route_stops) {
 				//here call the conversion function
-				geo::PointOnPlane geoPt = proj(stp->location);
+				geo::PointOnPlane geoPt = proj(columns.GetCoordinates(stp->id));
 				pts.push_back({ geoPt.X,geoPt.Y});
 			}
 			return BusShape(pts, color, stroke_width);
 		}
 
-		LabelBusShape GetLabelBusShape(Bus* bus, geo::SphereProjector& proj, svg::Color bus_color, RendererParameters& params) {
+		LabelBusShape GetLabelBusShape(Bus* bus, geo::SphereProjector& proj, svg::Color bus_color, RendererParameters& params, const StopColumns& columns) {
 
 			std::vector<svg::Point> locations;
 			Stop* start_stop = (bus->stops)[0];
-			geo::PointOnPlane geoStart = proj(start_stop->location);
+			geo::PointOnPlane geoStart = proj(columns.GetCoordinates(start_stop->id));
 			locations.push_back({ geoStart.X , geoStart.Y });
 			
-			Stop* end_stop = bus->end_stop;
+			Stop* end_stop = bus->GetEndStop();
 			if (start_stop != end_stop) {
 				//no round_trip case => need to add end_stop
-				geo::PointOnPlane geoEnd = proj(end_stop->location);
+				geo::PointOnPlane geoEnd = proj(columns.GetCoordinates(end_stop->id));
 				locations.push_back({ geoEnd.X , geoEnd.Y });
 			}
 
@@ -220,20 +221,20 @@ namespace catalogue {
 		}
 
 
-		StopShape GetStopShape(Stop* stop, geo::SphereProjector& proj,  RendererParameters& params) {
-			geo::PointOnPlane geoStop = proj(stop->location);
+		StopShape GetStopShape(size_t stop_id, geo::SphereProjector& proj,  RendererParameters& params, const StopColumns& columns) {
+			geo::PointOnPlane geoStop = proj(columns.GetCoordinates(stop_id));
 			svg::Point location{geoStop.X,geoStop.Y};
 			return StopShape(location,params.stop_radius);
 		}
 
-		StopLabelShape GetStopLabelShape(Stop* stop, geo::SphereProjector& proj, RendererParameters& params) {
-			geo::PointOnPlane geoStop = proj(stop->location);
+		StopLabelShape GetStopLabelShape(size_t stop_id, geo::SphereProjector& proj, RendererParameters& params, const StopColumns& columns) {
+			geo::PointOnPlane geoStop = proj(columns.GetCoordinates(stop_id));
 			svg::Point location{ geoStop.X,geoStop.Y };
 			return StopLabelShape(
 				location,
 				params.stop_label_offset,
 				params.stop_label_font_size,
-				stop->stop_name,
+				std::string(columns.GetName(stop_id)),
 				params.underlayer_color,
 				params.underlayer_width
 				);
@@ -244,7 +245,8 @@ namespace catalogue {
 		void DrawBusLines(std::vector<std::unique_ptr<svg::Drawable>>& picture,
 			std::vector<Bus*> buses,
 			geo::SphereProjector& projector,
-			RendererParameters params) {
+			RendererParameters params,
+			const StopColumns& columns) {
 
 			std::vector<svg::Color> clrs = params.color_palette;
 			size_t color_count = 0;
@@ -253,7 +255,7 @@ namespace catalogue {
 				///only draw if the bus line has stops
 				if ((b->stops).size() != 0) {
 					svg::Color clr_bus = clrs[color_count];
-					picture.emplace_back(std::make_unique<renderer::BusShape>(renderer::GetBusShape(b, projector, clr_bus, params.line_width)));
+					picture.emplace_back(std::make_unique<renderer::BusShape>(renderer::GetBusShape(b, projector, clr_bus, params.line_width, columns)));
 					if (color_count == clrs.size() - 1) {
 						//if we just used the last color in the list, go back to the begining
 						color_count = 0;
@@ -269,7 +271,8 @@ namespace catalogue {
 		void DrawBusLabels(std::vector<std::unique_ptr<svg::Drawable>>& picture,
 			std::vector<Bus*> buses,
 			geo::SphereProjector& projector,
-			RendererParameters params) {
+			RendererParameters params,
+			const StopColumns& columns) {
 
 			std::vector<svg::Color> clrs = params.color_palette;
 			size_t clr_bus_label = 0;
@@ -277,7 +280,7 @@ namespace catalogue {
 				///only draw if the bus line has stops
 				if ((b->stops).size() != 0) {
 					svg::Color clr_bus = clrs[clr_bus_label];
-					picture.emplace_back(std::make_unique<renderer::LabelBusShape>(renderer::GetLabelBusShape(b, projector, clr_bus, params)));
+					picture.emplace_back(std::make_unique<renderer::LabelBusShape>(renderer::GetLabelBusShape(b, projector, clr_bus, params, columns)));
 					if (clr_bus_label == clrs.size() - 1) {
 						//if we just used the last color in the list, go back to the begining
 						clr_bus_label = 0;
@@ -291,48 +294,64 @@ namespace catalogue {
 		}
 
 		void DrawStops(std::vector<std::unique_ptr<svg::Drawable>>& picture,
-			std::vector<Stop*> stops,
+			const std::vector<size_t>& stop_ids,
 			geo::SphereProjector& projector,
-			RendererParameters params) {
-			for (const auto stp : stops) {
-				picture.emplace_back(std::make_unique<renderer::StopShape>(renderer::GetStopShape(stp, projector, params)));
+			RendererParameters params,
+			const StopColumns& columns) {
+			for (const size_t id : stop_ids) {
+				picture.emplace_back(std::make_unique<renderer::StopShape>(renderer::GetStopShape(id, projector, params, columns)));
 			}
 		}
 
 		void DrawStopLabels(std::vector<std::unique_ptr<svg::Drawable>>& picture,
-			std::vector<Stop*> stops,
+			const std::vector<size_t>& stop_ids,
 			geo::SphereProjector& projector,
-			RendererParameters params) {
+			RendererParameters params,
+			const StopColumns& columns) {
 
-			for (const auto stp : stops) {
-				picture.emplace_back(std::make_unique<renderer::StopLabelShape>(renderer::GetStopLabelShape(stp, projector, params)));
+			for (const size_t id : stop_ids) {
+				picture.emplace_back(std::make_unique<renderer::StopLabelShape>(renderer::GetStopLabelShape(id, projector, params, columns)));
 			}
 
 		}
 
+		std::vector<size_t> GetStopIds(const std::vector<Stop*>& stops) {
+			std::vector<size_t> ids;
+			ids.reserve(stops.size());
+			for (const Stop* stop : stops) {
+				ids.push_back(stop->id);
+			}
+			return ids;
+		}
+
 		void DrawNetworkMap(std::ostream& out, renderer::NetworkDrawingData data) {
-			//initialize projector
-			std::vector< geo::Coordinates> geo_coords;
-			for (const auto stp : data.stops) {
-				geo_coords.push_back(stp->location);
+			//initialize projector: only the coordinates of the drawn stops
+			const StopColumns& columns = *data.columns;
+			std::vector<double> lats;
+			std::vector<double> lngs;
+			lats.reserve(data.stop_ids.size());
+			lngs.reserve(data.stop_ids.size());
+			for (const size_t id : data.stop_ids) {
+				lats.push_back(columns.lat[id]);
+				lngs.push_back(columns.lng[id]);
 			}
 
-			geo::SphereProjector projector(geo_coords.begin(), geo_coords.end(), data.params.width, data.params.height, data.params.padding);
+			geo::SphereProjector projector(lats, lngs, data.params.width, data.params.height, data.params.padding);
 			
 			svg::Document doc;
 			std::vector<svg::Color> clrs = data.params.color_palette;
 			std::vector<std::unique_ptr<svg::Drawable>> picture;
 			//add buses to Picture
-			DrawBusLines(picture,data.buses,projector,data.params);
+			DrawBusLines(picture,data.buses,projector,data.params,columns);
 
 			//add bus labels to Picture
-			DrawBusLabels(picture, data.buses, projector, data.params);
+			DrawBusLabels(picture, data.buses, projector, data.params, columns);
 
 			//add stops to Picture
-			DrawStops(picture, data.stops, projector, data.params);
+			DrawStops(picture, data.stop_ids, projector, data.params, columns);
 
 			//add stop labels to Picture
-			DrawStopLabels(picture, data.stops, projector, data.params);
+			DrawStopLabels(picture, data.stop_ids, projector, data.params, columns);
 
 			//draw picture
 			DrawPicture(picture, doc);
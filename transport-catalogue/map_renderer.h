@@ -40,8 +40,11 @@ namespace catalogue {
 		/// </summary>
 		struct NetworkDrawingData {
 			std::vector<Bus*> buses;
-			std::vector<Stop*> stops;
+			//Stop::id of the stops to draw, in the order of drawing
+			std::vector<size_t> stop_ids;
 			RendererParameters params;
+			//coordinates and names of all the stops by Stop::id
+			const StopColumns* columns;
 		};
 
 		
@@ -135,34 +138,43 @@ namespace catalogue {
 		};
 
 
-		BusShape GetBusShape(Bus* bus, geo::SphereProjector& proj, svg::Color Color , double stroke_width);
+		BusShape GetBusShape(Bus* bus, geo::SphereProjector& proj, svg::Color Color , double stroke_width, const StopColumns& columns);
 
-		LabelBusShape GetLabelBusShape(Bus* bus, geo::SphereProjector& proj, svg::Color color, RendererParameters& params);
+		LabelBusShape GetLabelBusShape(Bus* bus, geo::SphereProjector& proj, svg::Color color, RendererParameters& params, const StopColumns& columns);
 
-		StopShape GetStopShape(Stop* stop, geo::SphereProjector& proj, RendererParameters& params);
+		StopShape GetStopShape(size_t stop_id, geo::SphereProjector& proj, RendererParameters& params, const StopColumns& columns);
 
-		StopLabelShape GetStopLabelShape(Stop* stop, geo::SphereProjector& proj, RendererParameters& params);
+		StopLabelShape GetStopLabelShape(size_t stop_id, geo::SphereProjector& proj, RendererParameters& params, const StopColumns& columns);
+
+		/// <summary>
+		/// Stop::id of every stop, for NetworkDrawingData::stop_ids.
+		/// </summary>
+		std::vector<size_t> GetStopIds(const std::vector<Stop*>& stops);
 
 
 		void DrawBusLines(std::vector<std::unique_ptr<svg::Drawable>>& picture,
 						  std::vector<Bus*> buses,
 						  geo::SphereProjector& projector,
-						  RendererParameters params);
+						  RendererParameters params,
+						  const StopColumns& columns);
 
 		void DrawBusLabels(std::vector<std::unique_ptr<svg::Drawable>>& picture,
 						   std::vector<Bus*> buses,
 						   geo::SphereProjector& projector,
-						   RendererParameters params);
+						   RendererParameters params,
+						   const StopColumns& columns);
 
 		void DrawStops(std::vector<std::unique_ptr<svg::Drawable>>& picture,
-					   std::vector<Stop*> stops,
+					   const std::vector<size_t>& stop_ids,
 					   geo::SphereProjector& projector,
-					   RendererParameters params);
+					   RendererParameters params,
+					   const StopColumns& columns);
 
 		void DrawStopLabels(std::vector<std::unique_ptr<svg::Drawable>>& picture,
-							std::vector<Stop*> stops,
+							const std::vector<size_t>& stop_ids,
 							geo::SphereProjector& projector,
-							RendererParameters params);
+							RendererParameters params,
+							const StopColumns& columns);
 
 		/// <summary>
 		/// Draw a SVG-Map with bus and stops lines.
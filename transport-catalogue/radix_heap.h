@@ -0,0 +1,124 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    /// <summary>
+    /// Monotone min-priority queue with unsigned integer keys (radix heap).
+    /// A pushed key must not be smaller than the last popped one, which holds for Dijkstra.
+    /// Bucket i holds the keys whose highest bit different from the last popped key is bit i-1
+    /// (bucket 0: keys equal to it). An item moves to lower buckets only, at most once per bit,
+    /// so push is O(1) and pop is amortized O(log C), C the largest key, without comparisons
+    /// between items. Same interface as std::priority_queue with std::greater.
+    /// </summary>
+    template <typename Key, typename Value>
+    class RadixHeap {
+        static_assert(std::is_unsigned_v<Key>, "RadixHeap needs unsigned keys");
+
+    public:
+        using Item = std::pair<Key, Value>;
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        void push(const Item& item) {
+            if (item.first < last_) {
+                throw std::invalid_argument("Key is smaller than the last popped key");
+            }
+            buckets_[GetBucket(item.first)].push_back(item);
+            ++size_;
+        }
+
+        /// <summary>
+        /// Item with the smallest key. Not const: the buckets may be redistributed.
+        /// </summary>
+        const Item& top() {
+            Refill();
+            return buckets_[0].back();
+        }
+
+        void pop() {
+            Refill();
+            buckets_[0].pop_back();
+            --size_;
+        }
+
+    private:
+        static constexpr size_t KEY_BITS = std::numeric_limits<Key>::digits;
+
+        static size_t GetBitWidth(Key key) {
+            size_t width = 0;
+            for (size_t shift = KEY_BITS / 2; shift > 0; shift /= 2) {
+                if (key >> shift) {
+                    key >>= shift;
+                    width += shift;
+                }
+            }
+            return width + (key != 0 ? 1 : 0);
+        }
+
+        size_t GetBucket(Key key) const {
+            return GetBitWidth(key ^ last_);
+        }
+
+        /// <summary>
+        /// Make bucket 0 non-empty: the smallest key of the first non-empty bucket becomes
+        /// the last key and the bucket is spread over the lower ones.
+        /// </summary>
+        void Refill() {
+            if (!buckets_[0].empty()) {
+                return;
+            }
+            if (size_ == 0) {
+                throw std::out_of_range("Heap is empty");
+            }
+            size_t bucket = 1;
+            while (buckets_[bucket].empty()) {
+                ++bucket;
+            }
+            std::vector<Item> items;
+            items.swap(buckets_[bucket]);
+            last_ = items.front().first;
+            for (const Item& item : items) {
+                last_ = std::min(last_, item.first);
+            }
+            for (const Item& item : items) {
+                buckets_[GetBucket(item.first)].push_back(item);
+            }
+            //keep the capacity for the next time
+            items.clear();
+            items.swap(buckets_[bucket]);
+        }
+
+        std::array<std::vector<Item>, KEY_BITS + 1> buckets_;
+        Key last_ = 0;
+        size_t size_ = 0;
+    };
+
+    /// <summary>
+    /// Queue of (distance, vertex) for the Dijkstra searches: a radix heap for unsigned
+    /// integer weights, a binary heap otherwise.
+    /// </summary>
+    template <typename Weight>
+    using SearchQueue = std::conditional_t<std::is_integral_v<Weight> && std::is_unsigned_v<Weight>,
+        RadixHeap<Weight, VertexId>,
+        std::priority_queue<std::pair<Weight, VertexId>, std::vector<std::pair<Weight, VertexId>>,
+            std::greater<std::pair<Weight, VertexId>>>>;
+
+}  // namespace graph
@@ -0,0 +1,191 @@
+#include "raptor.h"
+
+#include <algorithm>
+
+
+
+TimetableRouter::TimetableRouter(const catalogue::TransportCatalogue& catalogue, double velocity) {
+	for (const catalogue::Stop& stop : catalogue.GetStops()) {
+		stop_ids_[&stop] = static_cast<uint32_t>(stops_.size());
+		stops_.push_back(&stop);
+	}
+
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> routes_of_stop(stops_.size());
+	for (const catalogue::Bus* bus : catalogue.GetAllBuses()) {
+		if (bus->departures.empty()) {
+			continue;
+		}
+		//the next trip starts when the previous one arrives
+		double trip_start = 0;
+		for (const std::vector<catalogue::Stop*>& trip : catalogue.GetTrips(bus)) {
+			const std::vector<double> ride_times = catalogue.GetTripTimes(trip, velocity);
+			if (trip.size() >= 2) {
+				const uint32_t route_id = static_cast<uint32_t>(routes_.size());
+				Route route{ bus,
+					static_cast<uint32_t>(route_stops_.size()), static_cast<uint32_t>(trip.size()),
+					static_cast<uint32_t>(stop_times_.size()), static_cast<uint32_t>(bus->departures.size()) };
+				for (uint32_t position = 0; position < route.stop_count; ++position) {
+					const uint32_t stop_id = stop_ids_.at(trip[position]);
+					route_stops_.push_back(stop_id);
+					routes_of_stop[stop_id].push_back({ route_id, position });
+				}
+				//departures are sorted: so are the runs, at every stop
+				for (double departure : bus->departures) {
+					for (double ride_time : ride_times) {
+						stop_times_.push_back(departure + trip_start + ride_time);
+					}
+				}
+				routes_.push_back(route);
+			}
+			trip_start += ride_times.back();
+		}
+	}
+
+	stop_routes_offsets_.push_back(0);
+	for (const auto& routes : routes_of_stop) {
+		stop_routes_.insert(stop_routes_.end(), routes.begin(), routes.end());
+		stop_routes_offsets_.push_back(static_cast<uint32_t>(stop_routes_.size()));
+	}
+}
+
+
+
+double TimetableRouter::GetStopTime(const Route& route, uint32_t run, uint32_t position) const {
+	return stop_times_[route.times_begin + static_cast<size_t>(run) * route.stop_count + position];
+}
+
+uint32_t TimetableRouter::FindEarliestRun(const Route& route, uint32_t position, double time, uint32_t run_end) const {
+	uint32_t low = 0;
+	uint32_t high = run_end;
+	while (low < high) {
+		const uint32_t middle = low + (high - low) / 2;
+		if (GetStopTime(route, middle, position) < time) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+
+
+TransportRouteInfo TimetableRouter::FindEarliestArrival(const catalogue::Stop* from, const catalogue::Stop* to, double departure_time,
+	size_t max_rides) const {
+	if (from == nullptr || to == nullptr || stop_ids_.count(from) == 0 || stop_ids_.count(to) == 0) {
+		return { false, 0, {} };
+	}
+	if (from == to) {
+		return { true, 0, {} };
+	}
+	const uint32_t source = stop_ids_.at(from);
+	const uint32_t target = stop_ids_.at(to);
+	const double INF = std::numeric_limits<double>::infinity();
+
+	//arrivals[k][s]: earliest arrival at s with at most k rides, rides[k][s]: the ride of round k there
+	std::vector<std::vector<double>> arrivals{ std::vector<double>(stops_.size(), INF) };
+	std::vector<std::vector<Ride>> rides{ std::vector<Ride>(stops_.size()) };
+	std::vector<double> best(stops_.size(), INF);
+	arrivals[0][source] = departure_time;
+	best[source] = departure_time;
+
+	std::vector<uint32_t> marked_stops{ source };
+	std::vector<bool> is_marked(stops_.size(), false);
+	is_marked[source] = true;
+	//first position of a marked stop on the route
+	std::vector<uint32_t> first_position(routes_.size(), NONE);
+	std::vector<uint32_t> queued_routes;
+
+	for (size_t round = 1; round <= max_rides && !marked_stops.empty(); ++round) {
+		for (uint32_t stop : marked_stops) {
+			is_marked[stop] = false;
+			for (uint32_t k = stop_routes_offsets_[stop]; k < stop_routes_offsets_[stop + 1]; ++k) {
+				const auto [route_id, position] = stop_routes_[k];
+				if (first_position[route_id] == NONE) {
+					queued_routes.push_back(route_id);
+				}
+				first_position[route_id] = std::min(first_position[route_id], position);
+			}
+		}
+		marked_stops.clear();
+
+		arrivals.push_back(arrivals.back());
+		rides.emplace_back(stops_.size());
+		const std::vector<double>& previous = arrivals[round - 1];
+		std::vector<double>& current = arrivals[round];
+
+		for (uint32_t route_id : queued_routes) {
+			const Route& route = routes_[route_id];
+			//run_count: no run boarded yet
+			uint32_t run = route.run_count;
+			uint32_t board = NONE;
+			for (uint32_t position = first_position[route_id]; position < route.stop_count; ++position) {
+				const uint32_t stop = route_stops_[route.stops_begin + position];
+				if (run < route.run_count) {
+					const double time = GetStopTime(route, run, position);
+					if (time < std::min(best[stop], best[target])) {
+						current[stop] = time;
+						best[stop] = time;
+						rides[round][stop] = { route_id, run, board, position };
+						if (!is_marked[stop]) {
+							is_marked[stop] = true;
+							marked_stops.push_back(stop);
+						}
+					}
+				}
+				//never board at the last stop
+				if (position + 1 < route.stop_count && previous[stop] < INF) {
+					const uint32_t earlier = FindEarliestRun(route, position, previous[stop], run);
+					if (earlier < run) {
+						run = earlier;
+						board = position;
+					}
+				}
+			}
+			first_position[route_id] = NONE;
+		}
+		queued_routes.clear();
+	}
+
+	if (best[target] == INF) {
+		return { false, 0, {} };
+	}
+
+	//fewest rides among the earliest arrivals
+	size_t round = 1;
+	while (arrivals[round][target] != best[target]) {
+		++round;
+	}
+	std::vector<RouteItem> items;
+	uint32_t stop = target;
+	while (stop != source) {
+		//a label copied from the round before has no ride of its own
+		while (rides[round][stop].route == NONE) {
+			--round;
+		}
+		const Ride& ride = rides[round][stop];
+		const Route& route = routes_[ride.route];
+		const uint32_t board_stop = route_stops_[route.stops_begin + ride.board];
+		const double board_time = GetStopTime(route, ride.run, ride.board);
+		const double alight_time = GetStopTime(route, ride.run, ride.alight);
+		items.push_back(BusItem{ route.bus->bus_name, alight_time - board_time, static_cast<int>(ride.alight - ride.board) });
+		items.push_back(WaitItem{ stops_[board_stop]->stop_name, board_time - arrivals[round - 1][board_stop] });
+		stop = board_stop;
+		--round;
+	}
+	std::reverse(items.begin(), items.end());
+	return { true, best[target] - departure_time, items };
+}
+
+size_t TimetableRouter::GetRouteCount() const {
+	return routes_.size();
+}
+
+size_t TimetableRouter::GetRunCount() const {
+	size_t result = 0;
+	for (const Route& route : routes_) {
+		result += route.run_count;
+	}
+	return result;
+}
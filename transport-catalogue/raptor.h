@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+
+/// <summary>
+/// Earliest-arrival routes over the bus timetables (RAPTOR: one round per bus ride).
+/// Every trip of a bus with departures (GetTrips) is a route; its runs leave the first stop
+/// at the bus departures (the way back of a straight bus when the way there arrives) and reach
+/// the next stops after the ride time at the given velocity. Routes, their stops and the stop
+/// times are kept in flat arrays. Buses without departures are not in the timetable.
+/// A transfer at a stop takes no time: any later run can be boarded.
+/// </summary>
+class TimetableRouter {
+public:
+	TimetableRouter(const catalogue::TransportCatalogue& catalogue, double velocity);
+
+	/// <summary>
+	/// Earliest arrival at to, leaving from not before departure_time (minutes since midnight),
+	/// with at most max_rides bus rides (the fewest rides among the earliest routes).
+	/// total_time: from departure_time to the arrival; a Wait item is the wait for the run
+	/// boarded next, a Bus item the time on board.
+	/// </summary>
+	TransportRouteInfo FindEarliestArrival(const catalogue::Stop* from, const catalogue::Stop* to, double departure_time,
+		size_t max_rides = std::numeric_limits<size_t>::max()) const;
+
+	size_t GetRouteCount() const;
+
+	/// <summary>
+	/// Number of runs of all the routes.
+	/// </summary>
+	size_t GetRunCount() const;
+
+private:
+	struct Route {
+		const catalogue::Bus* bus;
+		//stops in route_stops_[stops_begin, stops_begin + stop_count)
+		uint32_t stops_begin;
+		uint32_t stop_count;
+		//run r at position i: stop_times_[times_begin + r * stop_count + i], runs by departure
+		uint32_t times_begin;
+		uint32_t run_count;
+	};
+
+	/// <summary>
+	/// Ride of a round: from board to alight (positions in the route).
+	/// </summary>
+	struct Ride {
+		uint32_t route = NONE;
+		uint32_t run = NONE;
+		uint32_t board = NONE;
+		uint32_t alight = NONE;
+	};
+
+	static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+	double GetStopTime(const Route& route, uint32_t run, uint32_t position) const;
+
+	/// <summary>
+	/// First run among [0, run_end) leaving the position not before time, run_end if none.
+	/// </summary>
+	uint32_t FindEarliestRun(const Route& route, uint32_t position, double time, uint32_t run_end) const;
+
+	std::vector<const catalogue::Stop*> stops_;
+	std::unordered_map<const catalogue::Stop*, uint32_t> stop_ids_;
+
+	std::vector<Route> routes_;
+	std::vector<uint32_t> route_stops_;
+	std::vector<double> stop_times_;
+
+	//routes of the stop s with its position: stop_routes_[stop_routes_offsets_[s], stop_routes_offsets_[s + 1])
+	std::vector<uint32_t> stop_routes_offsets_;
+	std::vector<std::pair<uint32_t, uint32_t>> stop_routes_;
+};
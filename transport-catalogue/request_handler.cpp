@@ -1,5 +1,6 @@
 #include "request_handler.h"
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <unordered_map>
@@ -105,7 +106,7 @@ namespace catalogue {
 		}
 
 
-		std::pair<std::string, std::vector<std::string>> ParseBusData(const std::string& text) {
+		BusInputData ParseBusData(const std::string& text) {
 			std::pair<std::string, std::string> bus_data = detail::Split(text, ':');
 
 			std::string bus_name = detail::Trim(bus_data.first);
@@ -126,21 +127,10 @@ namespace catalogue {
 				while (getline(strstream, segment, '-')) {
 					stops.push_back(detail::Trim(segment));
 				}
-
-				int q = (int)(stops.size() - 2);
-				{
-					while (q >= 0) {
-						std::string stp = stops[q];
-						stops.push_back(stp);
-						--q;
-					}
-				}
-
-
 			}
 
 
-			return { bus_name , stops };
+			return { bus_name , stops, is_cirular ? RouteKind::ROUND_TRIP : RouteKind::STRAIGHT };
 		}
 
 
@@ -168,8 +158,7 @@ namespace catalogue {
 			for (const auto& r : requests) {
 				if (r.type == input::InputType::BUS) {
 					auto bus = input::ParseBusData(r.text);
-					//the next line is in Principle !!!FALSE!!!
-					catalogue.AddBus(bus.first, bus.second,bus.second[0]);
+					catalogue.AddBus(bus.name, bus.stops, bus.kind);
 				}
 			}
 
@@ -199,7 +188,10 @@ namespace catalogue {
 			}
 
 			for (const auto& bus : bus_data) {
-				catalogue.AddBus(bus.name,bus.stops, bus.end_stop);
+				catalogue.AddBus(bus.name,bus.stops, bus.kind);
+				if (!bus.departures.empty()) {
+					catalogue.SetBusDepartures(bus.name, bus.departures);
+				}
 			}
 		}
 
@@ -293,6 +285,155 @@ namespace catalogue {
 
 
 
+	}
+
+
+	//----REQUEST HANDLER----
+
+	RequestHandler::RequestHandler(TransportCatalogue& catalogue, renderer::RendererParameters params, RoutingSettings routing,
+		StopIndex stop_index, graph::HubLabelStorage<GraphTime> hub_labels)
+		: catalogue_(catalogue)
+		, params_(std::move(params))
+		, routing_(routing)
+		, hub_labels_(std::move(hub_labels))
+		, stop_index_(std::move(stop_index)) {
+	}
+
+	BusInfo RequestHandler::GetBusInfo(const std::string& bus) const {
+		return catalogue_.GetBusInfo(bus);
+	}
+
+	StopInfo RequestHandler::GetStopInfo(const std::string& stop) const {
+		return catalogue_.GetStopInfo(stop);
+	}
+
+	std::shared_ptr<const TransportRouteInfo> RequestHandler::FindRoute(const std::string& from, const std::string& to) const {
+		return GetGraph().FindRoute({ catalogue_.FindStop(from), catalogue_.FindStop(to) });
+	}
+
+	TransportRouteInfo RequestHandler::FindRoute(const std::string& from, const std::string& to, const RoutingOverride& routing_override) const {
+		return GetGraph().FindRoute({ catalogue_.FindStop(from), catalogue_.FindStop(to) }, routing_override);
+	}
+
+	TransportRouteInfo RequestHandler::FindTravelTime(const std::string& from, const std::string& to, bool with_items) const {
+		return GetGraph().FindTravelTime({ catalogue_.FindStop(from), catalogue_.FindStop(to) }, with_items);
+	}
+
+	TransportRouteInfo RequestHandler::FindTimetableRoute(const std::string& from, const std::string& to, double departure_time) const {
+		if (routing_.timetable_engine == TimetableEngine::CONNECTION_SCAN) {
+			return GetConnections().FindEarliestArrival(catalogue_.FindStop(from), catalogue_.FindStop(to), departure_time);
+		}
+		return GetTimetable().FindEarliestArrival(catalogue_.FindStop(from), catalogue_.FindStop(to), departure_time);
+	}
+
+	std::vector<ProfileEntry> RequestHandler::FindProfile(const std::string& from, const std::string& to, double window_begin, double window_end) const {
+		return GetConnections().FindProfile(catalogue_.FindStop(from), catalogue_.FindStop(to), window_begin, window_end);
+	}
+
+	std::vector<std::shared_ptr<const TransportRouteInfo>> RequestHandler::FindRoutesFrom(const std::string& from, const std::vector<std::string>& to) const {
+		std::vector<Stop*> to_stops;
+		for (const std::string& stop : to) {
+			to_stops.push_back(catalogue_.FindStop(stop));
+		}
+		return GetGraph().FindRoutesFromOrigin(catalogue_.FindStop(from), to_stops);
+	}
+
+	std::vector<std::vector<std::optional<double>>> RequestHandler::GetTravelTimeMatrix(const std::vector<std::string>& from, const std::vector<std::string>& to) const {
+		std::vector<Stop*> from_stops;
+		for (const std::string& stop : from) {
+			from_stops.push_back(catalogue_.FindStop(stop));
+		}
+		std::vector<Stop*> to_stops;
+		for (const std::string& stop : to) {
+			to_stops.push_back(catalogue_.FindStop(stop));
+		}
+		return GetGraph().ComputeTravelTimes(from_stops, to_stops, matrix_thread_count_);
+	}
+
+	void RequestHandler::SetMatrixThreadCount(size_t thread_count) {
+		matrix_thread_count_ = std::max<size_t>(1, thread_count);
+	}
+
+	std::vector<std::pair<Stop*, double>> RequestHandler::GetReachableStops(const std::string& from, double time_budget) const {
+		return GetGraph().FindReachableStops(catalogue_.FindStop(from), time_budget);
+	}
+
+	std::vector<std::pair<const Stop*, double>> RequestHandler::GetNearestStops(geo::Coordinates location, size_t count, double radius) const {
+		std::vector<std::pair<const Stop*, double>> result;
+		for (const StopDistance& found : GetStopIndex().FindNearest(location, count, radius)) {
+			result.emplace_back(&catalogue_.GetStops()[found.stop_id], found.distance);
+		}
+		return result;
+	}
+
+	TransportRouteInfo RequestHandler::FindRouteBetweenPoints(geo::Coordinates from, geo::Coordinates to) const {
+		return GetGraph().FindRouteBetweenPoints(GetWalkableStops(from), GetWalkableStops(to), geo::ComputeDistance(from, to));
+	}
+
+	const StopIndex& RequestHandler::GetStopIndex() const {
+		std::call_once(stop_index_built_, [this]() {
+			if (stop_index_.GetSize() != catalogue_.GetStops().size()) {
+				stop_index_ = StopIndex(catalogue_.GetStopColumns());
+			}
+		});
+		return stop_index_;
+	}
+
+	const TimetableRouter& RequestHandler::GetTimetable() const {
+		std::call_once(timetable_built_, [this]() {
+			timetable_ = std::make_unique<TimetableRouter>(catalogue_, routing_.velocity);
+		});
+		return *timetable_;
+	}
+
+	const ConnectionScanRouter& RequestHandler::GetConnections() const {
+		std::call_once(connections_built_, [this]() {
+			connections_ = std::make_unique<ConnectionScanRouter>(catalogue_, routing_.velocity);
+		});
+		return *connections_;
+	}
+
+	std::vector<StopAccess> RequestHandler::GetWalkableStops(geo::Coordinates point) const {
+		std::vector<StopAccess> result;
+		for (const StopDistance& found : GetStopIndex().FindWithin(point, routing_.walk_radius)) {
+			result.push_back({ catalogue_.GetStop(found.stop_id), found.distance });
+		}
+		return result;
+	}
+
+	cache::CacheStats RequestHandler::GetRouteCacheStats() const {
+		if (!graph_ready_) {
+			return {};
+		}
+		return graph_wrapper_->GetRouteCacheStats();
+	}
+
+	const TransportGraphWrapper& RequestHandler::GetGraph() const {
+		std::call_once(graph_built_, [this]() {
+			auto graph_wrapper = std::make_unique<TransportGraphWrapper>(routing_, catalogue_);
+			graph_wrapper->BuildTransportGraph();
+			if (routing_.hub_labels) {
+				if (hub_labels_.IsEmpty()) {
+					graph_wrapper->BuildHubLabels();
+				}
+				else {
+					graph_wrapper->LoadHubLabels(std::move(hub_labels_));
+				}
+			}
+			graph_wrapper_ = std::move(graph_wrapper);
+			graph_ready_ = true;
+		});
+		return *graph_wrapper_;
+	}
+
+	const std::string& RequestHandler::GetMap() const {
+		std::call_once(map_rendered_, [this]() {
+			renderer::NetworkDrawingData drawing_data{ catalogue_.GetAllBuses(), renderer::GetStopIds(catalogue_.GetStopsPtrInNetwork()), params_, &catalogue_.GetStopColumns() };
+			std::ostringstream map_streamed;
+			renderer::DrawNetworkMap(map_streamed, drawing_data);
+			map_ = map_streamed.str();
+		});
+		return map_;
 	}
 
 
@@ -3,8 +3,17 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include "transport_catalogue.h"
 #include "transport_router.h"
+#include "raptor.h"
+#include "csa.h"
+#include "map_renderer.h"
+#include "stop_index.h"
+#include "thread_pool.h"
 
 
 
@@ -44,8 +53,11 @@ namespace catalogue {
 
 		struct BusInputData {
 			std::string name;
+			//one way for a STRAIGHT line
 			std::vector<std::string> stops;
-			std::string end_stop;
+			RouteKind kind;
+			//minutes since midnight from the first stop (optional timetable)
+			std::vector<double> departures = {};
 		};
 
 
@@ -62,9 +74,9 @@ namespace catalogue {
 		StopInputData ParseStopData(const std::string& text);
 
 		/// <summary>
-		/// Parse Bus text to bus_name + full stop route
+		/// Parse Bus text to bus_name + stops of the way there + kind ('>': round trip, '-': straight)
 		/// </summary>
-		std::pair<std::string, std::vector<std::string>> ParseBusData(const std::string& text);
+		BusInputData ParseBusData(const std::string& text);
 
 
 		/// <summary>
@@ -100,7 +112,15 @@ namespace catalogue {
 			STOP,
 			BUS,
 			MAP,
-			ROUTE
+			ROUTE,
+			ROUTE_CACHE_STATS,
+			MATRIX,
+			REACHABLE,
+			NEAREST_STOPS,
+			ROUTE_FROM_POINT,
+			TRAVEL_TIME,
+			TIMETABLE_ROUTE,
+			PROFILE
 		};
 
 
@@ -126,6 +146,27 @@ namespace catalogue {
 			std::string start;
 			//end stop is type = ROUTE
 			std::string end;
+			//origin stops if type = MATRIX
+			std::vector<std::string> from_stops = {};
+			//destination stops if type = MATRIX
+			std::vector<std::string> to_stops = {};
+			//time budget in minutes if type = REACHABLE (origin in start)
+			double time_budget = 0;
+			//point of a NEAREST_STOPS request, origin of a ROUTE_FROM_POINT request
+			geo::Coordinates location = {};
+			//destination of a ROUTE_FROM_POINT request
+			geo::Coordinates destination = {};
+			//velocity / wait time of this ROUTE request only
+			RoutingOverride routing_override = {};
+			//at most count stops not farther than radius (meters) if type = NEAREST_STOPS
+			size_t count = std::numeric_limits<size_t>::max();
+			double radius = std::numeric_limits<double>::infinity();
+			//route items wanted too if type = TRAVEL_TIME
+			bool with_items = false;
+			//minutes since midnight if type = TIMETABLE_ROUTE, window begin if type = PROFILE
+			double departure_time = 0;
+			//window end (minutes since midnight) if type = PROFILE
+			double window_end = 0;
 		};
 
 
@@ -156,4 +197,140 @@ namespace catalogue {
 
 
 	}
+
+
+	/// <summary>
+	/// Answers stat requests for a loaded catalogue. The routing graph/router and the map are
+	/// built on the first request that needs them. Several threads can call it at the same time.
+	/// </summary>
+	class RequestHandler {
+	public:
+		/// <summary>
+		/// stop_index: index read from the base; if it is empty, it is built on the first NearestStops request.
+		/// hub_labels: labels read from the base (routing.hub_labels); if empty, they are built with the graph.
+		/// </summary>
+		RequestHandler(TransportCatalogue& catalogue, renderer::RendererParameters params, RoutingSettings routing,
+			StopIndex stop_index = {}, graph::HubLabelStorage<GraphTime> hub_labels = {});
+
+		BusInfo GetBusInfo(const std::string& bus) const;
+
+		StopInfo GetStopInfo(const std::string& stop) const;
+
+		/// <summary>
+		/// Find route between two stops. The first call builds the graph and the router.
+		/// </summary>
+		std::shared_ptr<const TransportRouteInfo> FindRoute(const std::string& from, const std::string& to) const;
+
+		/// <summary>
+		/// Find route between two stops with another velocity and/or wait time (no rebuild, no cache).
+		/// </summary>
+		TransportRouteInfo FindRoute(const std::string& from, const std::string& to, const RoutingOverride& routing_override) const;
+
+		/// <summary>
+		/// Find routes from one stop to several stops at once (one search per origin).
+		/// </summary>
+		std::vector<std::shared_ptr<const TransportRouteInfo>> FindRoutesFrom(const std::string& from, const std::vector<std::string>& to) const;
+
+		/// <summary>
+		/// Travel times between every pair of origin and destination stops (result[i][j]).
+		/// </summary>
+		std::vector<std::vector<std::optional<double>>> GetTravelTimeMatrix(const std::vector<std::string>& from, const std::vector<std::string>& to) const;
+
+		/// <summary>
+		/// Threads of one travel time matrix. 1: computed on the calling thread, as a server
+		/// worker should (its pool already keeps the cores busy).
+		/// </summary>
+		void SetMatrixThreadCount(size_t thread_count);
+
+		/// <summary>
+		/// Stops reachable from a stop within time_budget minutes, closest first.
+		/// </summary>
+		std::vector<std::pair<Stop*, double>> GetReachableStops(const std::string& from, double time_budget) const;
+
+		/// <summary>
+		/// At most count stops not farther than radius (meters) from location, closest first.
+		/// </summary>
+		std::vector<std::pair<const Stop*, double>> GetNearestStops(geo::Coordinates location, size_t count, double radius) const;
+
+		/// <summary>
+		/// Best route between two points with walks to/from the stops within the walking radius.
+		/// </summary>
+		TransportRouteInfo FindRouteBetweenPoints(geo::Coordinates from, geo::Coordinates to) const;
+
+		/// <summary>
+		/// Travel time between two stops, from the hub labels if the base has them.
+		/// Route items only if with_items.
+		/// </summary>
+		TransportRouteInfo FindTravelTime(const std::string& from, const std::string& to, bool with_items) const;
+
+		/// <summary>
+		/// Earliest arrival over the bus timetables, leaving at departure_time (minutes since midnight).
+		/// The first call builds the timetable of the routing timetable_engine.
+		/// </summary>
+		TransportRouteInfo FindTimetableRoute(const std::string& from, const std::string& to, double departure_time) const;
+
+		/// <summary>
+		/// Pareto-optimal trips leaving between window_begin and window_end (connection scan).
+		/// </summary>
+		std::vector<ProfileEntry> FindProfile(const std::string& from, const std::string& to, double window_begin, double window_end) const;
+
+		/// <summary>
+		/// Hit/miss counters of the route cache (all zero until the graph is built).
+		/// </summary>
+		cache::CacheStats GetRouteCacheStats() const;
+
+		/// <summary>
+		/// SVG map of the network. The first call renders it, next calls reuse it.
+		/// </summary>
+		const std::string& GetMap() const;
+
+		/// <summary>
+		/// Graph+router over the catalogue, built on the first call.
+		/// </summary>
+		const TransportGraphWrapper& GetGraph() const;
+
+	private:
+		TransportCatalogue& catalogue_;
+		renderer::RendererParameters params_;
+		RoutingSettings routing_;
+		size_t matrix_thread_count_ = parallel::DefaultThreadCount();
+
+		mutable std::once_flag graph_built_;
+		mutable std::unique_ptr<TransportGraphWrapper> graph_wrapper_;
+		mutable std::atomic<bool> graph_ready_ = false;
+		//moved into the graph when it is built
+		mutable graph::HubLabelStorage<GraphTime> hub_labels_;
+
+		mutable std::once_flag map_rendered_;
+		mutable std::string map_;
+
+		mutable std::once_flag stop_index_built_;
+		mutable StopIndex stop_index_;
+
+		mutable std::once_flag timetable_built_;
+		mutable std::unique_ptr<TimetableRouter> timetable_;
+
+		mutable std::once_flag connections_built_;
+		mutable std::unique_ptr<ConnectionScanRouter> connections_;
+
+		/// <summary>
+		/// Index over the stops, built on the first call if the base had none.
+		/// </summary>
+		const StopIndex& GetStopIndex() const;
+
+		/// <summary>
+		/// Timetable router over the buses with departures, built on the first call.
+		/// </summary>
+		const TimetableRouter& GetTimetable() const;
+
+		/// <summary>
+		/// Connection scan over the buses with departures, built on the first call.
+		/// </summary>
+		const ConnectionScanRouter& GetConnections() const;
+
+		/// <summary>
+		/// Stops within the walking radius of a point.
+		/// </summary>
+		std::vector<StopAccess> GetWalkableStops(geo::Coordinates point) const;
+	};
 }
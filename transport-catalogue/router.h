@@ -1,11 +1,15 @@
 #pragma once
 
 #include "graph.h"
+#include "radix_heap.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <stdexcept>
 #include <unordered_map>
@@ -14,13 +18,40 @@
 
 namespace graph {
 
+    /// <summary>
+    /// How Router computes the route matrix.
+    /// FLOYD_WARSHALL: tiled Floyd-Warshall, O(V^3), its result does not depend on the thread count.
+    /// DIJKSTRA: one Dijkstra search per source vertex, O(V * E log V), much faster on sparse graphs.
+    /// Route weights are the same up to rounding, routes of equal weight may differ.
+    /// </summary>
+    enum class AllPairsAlgorithm {
+        FLOYD_WARSHALL,
+        DIJKSTRA
+    };
+
+    /// <summary>
+    /// All-pairs shortest paths, computed once in the constructor.
+    /// The matrix is stored as two contiguous V*V arrays (row = source vertex):
+    /// weights, with UNREACHABLE for missing routes, and 32-bit ids of the last edges of routes,
+    /// with NO_EDGE where there is none. A cell takes sizeof(Weight) + 4 bytes.
+    ///
+    /// The matrix is processed in TILE x TILE tiles, round by round (one round per diagonal tile):
+    /// the diagonal tile, then its row and column of tiles, then all other tiles, the tiles
+    /// of a phase in parallel. Row k and column k are saved at step k of the round, so every
+    /// cell is relaxed with exactly the same operands, in the same order, as in the plain
+    /// triple loop: the result does not depend on tiling or thread count.
+    ///
+    /// With AllPairsAlgorithm::DIJKSTRA the rows are independent single-source searches
+    /// run in parallel: each search writes the weights and the last edges of its source row.
+    /// </summary>
     template <typename Weight>
     class Router {
     private:
         using Graph = DirectedWeightedGraph<Weight>;
 
     public:
-        explicit Router(const Graph& graph);
+        explicit Router(const Graph& graph, AllPairsAlgorithm algorithm = AllPairsAlgorithm::FLOYD_WARSHALL,
+            size_t thread_count = parallel::DefaultThreadCount());
 
         struct RouteInfo {
             Weight weight;
@@ -30,88 +61,274 @@ namespace graph {
         std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
     private:
-        struct RouteInternalData {
-            Weight weight;
-            std::optional<EdgeId> prev_edge;
-        };
-        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+        using CompactEdgeId = uint32_t;
+
+        //64 x 64 tile of doubles + edge ids: 48 KB
+        static constexpr size_t TILE = 64;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr Weight UNREACHABLE = std::numeric_limits<Weight>::has_infinity
+            ? std::numeric_limits<Weight>::infinity()
+            : std::numeric_limits<Weight>::max();
+        static constexpr CompactEdgeId NO_EDGE = std::numeric_limits<CompactEdgeId>::max();
+
+        size_t GetCell(VertexId from, VertexId to) const {
+            return from * vertex_count_ + to;
+        }
 
         void InitializeRoutesInternalData(const Graph& graph) {
-            const size_t vertex_count = graph.GetVertexCount();
-            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-                routes_internal_data_[vertex][vertex] = RouteInternalData{ ZERO_WEIGHT, std::nullopt };
+            for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+                weights_[GetCell(vertex, vertex)] = ZERO_WEIGHT;
                 for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                     const auto& edge = graph.GetEdge(edge_id);
                     if (edge.weight < ZERO_WEIGHT) {
                         throw std::domain_error("Edges' weights should be non-negative");
                     }
-                    auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                    if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                        route_internal_data = RouteInternalData{ edge.weight, edge_id };
+                    const size_t cell = GetCell(vertex, edge.to);
+                    if (weights_[cell] == UNREACHABLE || weights_[cell] > edge.weight) {
+                        weights_[cell] = edge.weight;
+                        prev_edges_[cell] = static_cast<CompactEdgeId>(edge_id);
                     }
                 }
             }
         }
 
-        void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-            const RouteInternalData& route_to) {
-            auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-            const Weight candidate_weight = route_from.weight + route_to.weight;
-            if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-                route_relaxing = { candidate_weight,
-                                  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge };
+        /// <summary>
+        /// Relax count cells of a row through a vertex: the route to the vertex is
+        /// (weight_from, edge_from), the routes from it are through_weights/through_edges.
+        /// </summary>
+        static void RelaxRow(Weight weight_from, CompactEdgeId edge_from,
+            const Weight* through_weights, const CompactEdgeId* through_edges,
+            Weight* row_weights, CompactEdgeId* row_edges, size_t count);
+
+        /// <summary>
+        /// One round of the tiled Floyd-Warshall for the vertexes [round_begin, round_end).
+        /// </summary>
+        void RunRound(VertexId round_begin, VertexId round_end, size_t thread_count);
+
+        void ComputeFloydWarshall(size_t thread_count);
+
+        void ComputeDijkstra(size_t thread_count);
+
+        const Graph& graph_;
+        size_t vertex_count_;
+        std::vector<Weight> weights_;
+        std::vector<CompactEdgeId> prev_edges_;
+
+        //column k of the round at step k: [vertex * TILE + k - round_begin]
+        std::vector<Weight> column_weights_;
+        std::vector<CompactEdgeId> column_edges_;
+        //row k of the round at step k: [(k - round_begin) * vertex_count_ + vertex]
+        std::vector<Weight> row_weights_;
+        std::vector<CompactEdgeId> row_edges_;
+    };
+
+    template <typename Weight>
+    void Router<Weight>::RelaxRow(Weight weight_from, CompactEdgeId edge_from,
+        const Weight* through_weights, const CompactEdgeId* through_edges,
+        Weight* row_weights, CompactEdgeId* row_edges, size_t count) {
+        //branch-free min-plus, so that the compiler can vectorize it
+        for (size_t j = 0; j < count; ++j) {
+            const Weight candidate_weight = weight_from + through_weights[j];
+            const bool better = through_weights[j] != UNREACHABLE
+                && (row_weights[j] == UNREACHABLE || candidate_weight < row_weights[j]);
+            const CompactEdgeId candidate_edge = through_edges[j] != NO_EDGE ? through_edges[j] : edge_from;
+            row_weights[j] = better ? candidate_weight : row_weights[j];
+            row_edges[j] = better ? candidate_edge : row_edges[j];
+        }
+    }
+
+    template <typename Weight>
+    void Router<Weight>::RunRound(VertexId round_begin, VertexId round_end, size_t thread_count) {
+        const size_t tile_count = (vertex_count_ + TILE - 1) / TILE;
+        const size_t round_tile = round_begin / TILE;
+
+        auto save_column = [this, round_begin](VertexId vertex, VertexId k) {
+            column_weights_[vertex * TILE + k - round_begin] = weights_[GetCell(vertex, k)];
+            column_edges_[vertex * TILE + k - round_begin] = prev_edges_[GetCell(vertex, k)];
+        };
+        auto save_row = [this, round_begin](VertexId k, VertexId begin, VertexId end) {
+            std::copy(&weights_[GetCell(k, begin)], &weights_[GetCell(k, begin)] + (end - begin),
+                &row_weights_[(k - round_begin) * vertex_count_ + begin]);
+            std::copy(&prev_edges_[GetCell(k, begin)], &prev_edges_[GetCell(k, begin)] + (end - begin),
+                &row_edges_[(k - round_begin) * vertex_count_ + begin]);
+        };
+        //relax the row of vertex_from on [begin, end) through k, with the saved row and column
+        auto relax_saved = [this, round_begin](VertexId vertex_from, VertexId k, VertexId begin, VertexId end) {
+            const Weight weight_from = column_weights_[vertex_from * TILE + k - round_begin];
+            if (weight_from == UNREACHABLE) {
+                return;
+            }
+            const size_t saved = (k - round_begin) * vertex_count_ + begin;
+            RelaxRow(weight_from, column_edges_[vertex_from * TILE + k - round_begin],
+                &row_weights_[saved], &row_edges_[saved],
+                &weights_[GetCell(vertex_from, begin)], &prev_edges_[GetCell(vertex_from, begin)], end - begin);
+        };
+        auto tile_range = [this](size_t tile) {
+            return std::pair<VertexId, VertexId>{ tile * TILE, std::min(vertex_count_, (tile + 1) * TILE) };
+        };
+
+        //phase 1: diagonal tile
+        for (VertexId k = round_begin; k < round_end; ++k) {
+            save_row(k, round_begin, round_end);
+            for (VertexId vertex = round_begin; vertex < round_end; ++vertex) {
+                save_column(vertex, k);
+            }
+            for (VertexId vertex = round_begin; vertex < round_end; ++vertex) {
+                relax_saved(vertex, k, round_begin, round_end);
             }
         }
 
-        void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-                if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                    for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                        if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                        }
+        //phase 2: tiles in the row and the column of the diagonal tile
+        parallel::ParallelFor(2 * tile_count, thread_count, [&](size_t, size_t item) {
+            const size_t tile = item / 2;
+            if (tile == round_tile) {
+                return;
+            }
+            const auto [begin, end] = tile_range(tile);
+            if (item % 2 == 0) {
+                //row tile: rows of the round, columns of the tile
+                for (VertexId k = round_begin; k < round_end; ++k) {
+                    save_row(k, begin, end);
+                    for (VertexId vertex = round_begin; vertex < round_end; ++vertex) {
+                        relax_saved(vertex, k, begin, end);
+                    }
+                }
+            }
+            else {
+                //column tile: rows of the tile, columns of the round
+                for (VertexId vertex = begin; vertex < end; ++vertex) {
+                    for (VertexId k = round_begin; k < round_end; ++k) {
+                        save_column(vertex, k);
+                        relax_saved(vertex, k, round_begin, round_end);
                     }
                 }
             }
+        });
+
+        //phase 3: all other tiles, a band of rows per task
+        parallel::ParallelFor(tile_count, thread_count, [&](size_t, size_t row_tile) {
+            if (row_tile == round_tile) {
+                return;
+            }
+            const auto [row_begin, row_end] = tile_range(row_tile);
+            for (size_t column_tile = 0; column_tile < tile_count; ++column_tile) {
+                if (column_tile == round_tile) {
+                    continue;
+                }
+                const auto [begin, end] = tile_range(column_tile);
+                for (VertexId vertex = row_begin; vertex < row_end; ++vertex) {
+                    for (VertexId k = round_begin; k < round_end; ++k) {
+                        relax_saved(vertex, k, begin, end);
+                    }
+                }
+            }
+        });
+    }
+
+    template <typename Weight>
+    void Router<Weight>::ComputeFloydWarshall(size_t thread_count) {
+        column_weights_.resize(vertex_count_ * TILE);
+        column_edges_.resize(vertex_count_ * TILE);
+        row_weights_.resize(TILE * vertex_count_);
+        row_edges_.resize(TILE * vertex_count_);
+
+        InitializeRoutesInternalData(graph_);
+
+        for (VertexId round_begin = 0; round_begin < vertex_count_; round_begin += TILE) {
+            RunRound(round_begin, std::min(vertex_count_, round_begin + TILE), thread_count);
         }
 
-        static constexpr Weight ZERO_WEIGHT{};
-        const Graph& graph_;
-        RoutesInternalData routes_internal_data_;
-    };
+        //only needed while computing
+        column_weights_ = {};
+        column_edges_ = {};
+        row_weights_ = {};
+        row_edges_ = {};
+    }
 
     template <typename Weight>
-    Router<Weight>::Router(const Graph& graph)
+    void Router<Weight>::ComputeDijkstra(size_t thread_count) {
+        using Queue = SearchQueue<Weight>;
+
+        thread_count = std::max<size_t>(1, std::min(thread_count, vertex_count_));
+        //per-thread scratch: settled flags of the current source
+        std::vector<std::vector<bool>> settled(thread_count);
+
+        parallel::ParallelFor(vertex_count_, thread_count, [&](size_t thread_index, size_t source) {
+            std::vector<bool>& is_settled = settled[thread_index];
+            is_settled.assign(vertex_count_, false);
+            Queue queue;
+            //the row of the source holds the tentative distances and the last edges
+            Weight* row_weights = &weights_[GetCell(source, 0)];
+            CompactEdgeId* row_edges = &prev_edges_[GetCell(source, 0)];
+
+            row_weights[source] = ZERO_WEIGHT;
+            queue.push({ ZERO_WEIGHT, source });
+            while (!queue.empty()) {
+                const auto [distance, vertex] = queue.top();
+                queue.pop();
+                if (is_settled[vertex] || row_weights[vertex] < distance) {
+                    //outdated queue item
+                    continue;
+                }
+                is_settled[vertex] = true;
+                for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                    const auto& edge = graph_.GetEdge(edge_id);
+                    if (edge.weight < ZERO_WEIGHT) {
+                        throw std::domain_error("Edges' weights should be non-negative");
+                    }
+                    if (is_settled[edge.to]) {
+                        continue;
+                    }
+                    const Weight candidate = distance + edge.weight;
+                    if (row_weights[edge.to] == UNREACHABLE || candidate < row_weights[edge.to]) {
+                        row_weights[edge.to] = candidate;
+                        row_edges[edge.to] = static_cast<CompactEdgeId>(edge_id);
+                        queue.push({ candidate, edge.to });
+                    }
+                }
+            }
+        });
+    }
+
+    template <typename Weight>
+    Router<Weight>::Router(const Graph& graph, AllPairsAlgorithm algorithm, size_t thread_count)
         : graph_(graph)
-        , routes_internal_data_(graph.GetVertexCount(),
-            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+        , vertex_count_(graph.GetVertexCount())
+        , weights_(vertex_count_ * vertex_count_, UNREACHABLE)
+        , prev_edges_(vertex_count_ * vertex_count_, NO_EDGE)
     {
-        InitializeRoutesInternalData(graph);
-
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-            RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+        if (graph.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Too many edges for the route matrix");
+        }
+        if (algorithm == AllPairsAlgorithm::DIJKSTRA) {
+            ComputeDijkstra(thread_count);
+        }
+        else {
+            ComputeFloydWarshall(thread_count);
         }
     }
 
     template <typename Weight>
     std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
         VertexId to) const {
-        const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-        if (!route_internal_data) {
+        if (from >= vertex_count_ || to >= vertex_count_) {
+            throw std::out_of_range("Vertex is out of the graph");
+        }
+        const Weight weight = weights_[GetCell(from, to)];
+        if (weight == UNREACHABLE) {
             return std::nullopt;
         }
-        const Weight weight = route_internal_data->weight;
         std::vector<EdgeId> edges;
-        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-            edge_id;
-            edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+        for (CompactEdgeId edge_id = prev_edges_[GetCell(from, to)];
+            edge_id != NO_EDGE;
+            edge_id = prev_edges_[GetCell(from, graph_.GetEdge(edge_id).from)])
         {
-            edges.push_back(*edge_id);
+            edges.push_back(edge_id);
         }
         std::reverse(edges.begin(), edges.end());
 
         return RouteInfo{ weight, std::move(edges) };
     }
 
-}  // namespace graph
\ No newline at end of file
+}  // namespace graph
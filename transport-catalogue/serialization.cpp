@@ -1,6 +1,8 @@
 #include "serialization.h"
 #include "geo.h"
 
+#include <stdexcept>
+
 
 namespace serialization {
 
@@ -154,12 +156,50 @@ namespace serialization {
 		catalogue_serialize::RouterParameters object;
 		object.set_velocity(routing.velocity);
 		object.set_wait_time(routing.wait_time);
+		object.set_mode(routing.mode == RouterMode::PER_QUERY
+			? catalogue_serialize::RouterMode::PER_QUERY
+			: catalogue_serialize::RouterMode::ALL_PAIRS);
+		object.set_graph_model(routing.graph_model == GraphModel::RIDE_VERTICES
+			? catalogue_serialize::GraphModel::RIDE_VERTICES
+			: catalogue_serialize::GraphModel::STOP_PAIRS);
+		object.set_all_pairs_algorithm(routing.all_pairs_algorithm == graph::AllPairsAlgorithm::DIJKSTRA
+			? catalogue_serialize::AllPairsAlgorithm::DIJKSTRA
+			: catalogue_serialize::AllPairsAlgorithm::FLOYD_WARSHALL);
+		object.set_hub_labels(routing.hub_labels);
+		object.set_timetable_engine(routing.timetable_engine == TimetableEngine::CONNECTION_SCAN
+			? catalogue_serialize::TimetableEngine::CONNECTION_SCAN
+			: catalogue_serialize::TimetableEngine::RAPTOR);
+		object.set_vertex_order(routing.vertex_order == VertexOrder::HILBERT
+			? catalogue_serialize::VertexOrder::HILBERT
+			: catalogue_serialize::VertexOrder::ALPHABETICAL);
+		object.set_walk_velocity(routing.walk_velocity);
+		object.set_walk_radius(routing.walk_radius);
 		return object;
 	}
 
 
 	RoutingSettings DeserializeRouterSettings(catalogue_serialize::RouterParameters& object) {
 		RoutingSettings routing{ object.velocity(),object.wait_time()};
+		if (object.mode() == catalogue_serialize::RouterMode::PER_QUERY) {
+			routing.mode = RouterMode::PER_QUERY;
+		}
+		if (object.graph_model() == catalogue_serialize::GraphModel::RIDE_VERTICES) {
+			routing.graph_model = GraphModel::RIDE_VERTICES;
+		}
+		if (object.all_pairs_algorithm() == catalogue_serialize::AllPairsAlgorithm::DIJKSTRA) {
+			routing.all_pairs_algorithm = graph::AllPairsAlgorithm::DIJKSTRA;
+		}
+		routing.hub_labels = object.hub_labels();
+		if (object.timetable_engine() == catalogue_serialize::TimetableEngine::CONNECTION_SCAN) {
+			routing.timetable_engine = TimetableEngine::CONNECTION_SCAN;
+		}
+		if (object.vertex_order() == catalogue_serialize::VertexOrder::HILBERT) {
+			routing.vertex_order = VertexOrder::HILBERT;
+		}
+		if (object.walk_velocity() > 0) {
+			routing.walk_velocity = object.walk_velocity();
+			routing.walk_radius = object.walk_radius();
+		}
 		return routing;
 	}
 
@@ -198,11 +238,15 @@ namespace serialization {
 		for (const catalogue::Bus& bus : catalogue.GetBuses()) {
 			catalogue_serialize::Bus current_bus;
 			current_bus.set_name(bus.bus_name);
-			current_bus.set_end_stop(bus.end_stop->stop_name);
+			current_bus.set_is_roundtrip(bus.IsRoundTrip());
 
+			//one way for a straight line, as in the catalogue
 			for (auto& stop_ptr : bus.stops) {
 				current_bus.add_stop(stop_ptr->stop_name);
 			}
+			for (double departure : bus.departures) {
+				current_bus.add_departure(departure);
+			}
 
 			object.add_bus()->CopyFrom(current_bus);
 		}
@@ -228,7 +272,10 @@ namespace serialization {
 		}
 
 		for (const auto& elem : bus_data) {
-			catalogue.AddBus(elem.name, elem.stops, elem.end_stop);
+			catalogue.AddBus(elem.name, elem.stops, elem.kind);
+			if (!elem.departures.empty()) {
+				catalogue.SetBusDepartures(elem.name, elem.departures);
+			}
 		}
 
 	}
@@ -268,8 +315,20 @@ namespace serialization {
 				stops.push_back(*current_bus.mutable_stop(r));
 			}
 
-			std::string end_stop = *current_bus.mutable_end_stop();;
-			buses.push_back({ bus_name ,stops,end_stop });
+			catalogue::RouteKind kind = current_bus.is_roundtrip() ? catalogue::RouteKind::ROUND_TRIP : catalogue::RouteKind::STRAIGHT;
+			if (!current_bus.end_stop().empty()) {
+				//a base written before is_roundtrip: a round trip ends at its first stop,
+				//a straight line has its 2n - 1 stops there and back
+				if (!stops.empty() && current_bus.end_stop() == stops.front()) {
+					kind = catalogue::RouteKind::ROUND_TRIP;
+				}
+				else {
+					kind = catalogue::RouteKind::STRAIGHT;
+					stops.resize((stops.size() + 1) / 2);
+				}
+			}
+			std::vector<double> departures(current_bus.departure().begin(), current_bus.departure().end());
+			buses.push_back({ bus_name ,stops,kind, departures });
 		}
 
 		AddInfoFromDeserializedData(tc, stops, buses);
@@ -278,6 +337,78 @@ namespace serialization {
 	
 	}
 
+	//-----------------------------------------------------------------------------------------------------
+	//----STOP INDEX---
+	//-----------------------------------------------------------------------------------------------------
+
+	catalogue_serialize::StopIndex SerializeStopIndex(const catalogue::StopIndex& index) {
+		catalogue_serialize::StopIndex object;
+		for (uint32_t stop_id : index.GetOrder()) {
+			object.add_order(stop_id);
+		}
+		object.set_axes(std::string(index.GetAxes().begin(), index.GetAxes().end()));
+		return object;
+	}
+
+
+	catalogue::StopIndex DeserializeStopIndex(const catalogue_serialize::StopIndex& object, const catalogue::TransportCatalogue& catalogue) {
+		if (object.order_size() == 0) {
+			return {};
+		}
+		std::vector<uint32_t> order(object.order().begin(), object.order().end());
+		std::vector<uint8_t> axes(object.axes().begin(), object.axes().end());
+		return catalogue::StopIndex(catalogue.GetStopColumns(), std::move(order), std::move(axes));
+	}
+
+	//-----------------------------------------------------------------------------------------------------
+	//----HUB LABELS---
+	//-----------------------------------------------------------------------------------------------------
+
+	namespace {
+
+		void SerializeHubLabelArray(const std::vector<uint32_t>& offsets, const std::vector<graph::HubLabel<GraphTime>>& labels,
+			catalogue_serialize::HubLabelArray& object) {
+			for (uint32_t offset : offsets) {
+				object.add_offsets(offset);
+			}
+			for (const auto& label : labels) {
+				object.add_hubs(label.hub);
+				object.add_distances(label.distance);
+				object.add_edges(label.edge);
+			}
+		}
+
+		void DeserializeHubLabelArray(const catalogue_serialize::HubLabelArray& object,
+			std::vector<uint32_t>& offsets, std::vector<graph::HubLabel<GraphTime>>& labels) {
+			if (object.hubs_size() != object.distances_size() || object.hubs_size() != object.edges_size()) {
+				throw std::invalid_argument("Hub labels are corrupted");
+			}
+			offsets.assign(object.offsets().begin(), object.offsets().end());
+			labels.reserve(object.hubs_size());
+			for (int i = 0; i < object.hubs_size(); ++i) {
+				labels.push_back({ object.hubs(i), object.distances(i), object.edges(i) });
+			}
+		}
+
+	}
+
+	catalogue_serialize::HubLabels SerializeHubLabels(const graph::HubLabelStorage<GraphTime>& labels) {
+		catalogue_serialize::HubLabels object;
+		if (!labels.IsEmpty()) {
+			SerializeHubLabelArray(labels.out_offsets, labels.out_labels, *object.mutable_out_labels());
+			SerializeHubLabelArray(labels.in_offsets, labels.in_labels, *object.mutable_in_labels());
+		}
+		return object;
+	}
+
+
+	graph::HubLabelStorage<GraphTime> DeserializeHubLabels(const catalogue_serialize::HubLabels& object) {
+		graph::HubLabelStorage<GraphTime> labels;
+		DeserializeHubLabelArray(object.out_labels(), labels.out_offsets, labels.out_labels);
+		DeserializeHubLabelArray(object.in_labels(), labels.in_offsets, labels.in_labels);
+		return labels;
+	}
+
 	//-----------------------------------------------------------------------------------------------------
 	//----SYSTEM---
 	//-----------------------------------------------------------------------------------------------------
@@ -286,6 +417,8 @@ namespace serialization {
 		const catalogue::TransportCatalogue& catalogue,
 		const catalogue::renderer::RendererParameters& params,
 		const RoutingSettings& routing,
+		const catalogue::StopIndex& stop_index,
+		const graph::HubLabelStorage<GraphTime>& hub_labels,
 		std::ostream& output) {
 
 		catalogue_serialize::TransportSystem object;
@@ -293,6 +426,8 @@ namespace serialization {
 		*object.mutable_parameters() = SerializeMapSettings(params);
 		*object.mutable_catalogue() = SerializeTransportCatalogue(catalogue);
 		*object.mutable_routing() = SerializeRouterSettings(routing);
+		*object.mutable_stop_index() = SerializeStopIndex(stop_index);
+		*object.mutable_hub_labels() = SerializeHubLabels(hub_labels);
 
 
 		object.SerializeToOstream(&output);
@@ -302,6 +437,8 @@ namespace serialization {
 	catalogue::TransportCatalogue DeserializeTransportSystem(
 		catalogue::renderer::RendererParameters& params,
 		RoutingSettings& routing,
+		catalogue::StopIndex& stop_index,
+		graph::HubLabelStorage<GraphTime>& hub_labels,
 		std::istream& input) {
 
 		catalogue_serialize::TransportSystem object;
@@ -312,7 +449,9 @@ namespace serialization {
 		params = DeserializeMapSettings(*object.mutable_parameters());
 		routing = DeserializeRouterSettings(*object.mutable_routing());
 		catalogue::TransportCatalogue tc = DeserializeTransportCatalogue(*object.mutable_catalogue());
-
+		//stops are added in the serialized order, so the stored positions are valid
+		stop_index = DeserializeStopIndex(object.stop_index(), tc);
+		hub_labels = DeserializeHubLabels(object.hub_labels());
 
 		return tc;
 
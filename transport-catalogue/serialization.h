@@ -2,6 +2,7 @@
 #include <iostream>
 #include <transport_catalogue.pb.h>
 #include "map_renderer.h"
+#include "stop_index.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
@@ -19,7 +20,8 @@ namespace serialization{
 	struct DeserializedBus {
 		std::string name;
 		std::vector<std::string> stops;
-		std::string end_stop;
+		catalogue::RouteKind kind;
+		std::vector<double> departures = {};
 	};
 
 
@@ -45,15 +47,36 @@ namespace serialization{
 
 	catalogue::TransportCatalogue DeserializeTransportCatalogue(catalogue_serialize::TransportCatalogue& object);
 
+	catalogue_serialize::StopIndex SerializeStopIndex(const catalogue::StopIndex& index);
+
+
+	/// <summary>
+	/// Restore the index over the stops of the deserialized catalogue.
+	/// An empty index (base made before the index existed) is returned as is.
+	/// </summary>
+	catalogue::StopIndex DeserializeStopIndex(const catalogue_serialize::StopIndex& object, const catalogue::TransportCatalogue& catalogue);
+
+	catalogue_serialize::HubLabels SerializeHubLabels(const graph::HubLabelStorage<GraphTime>& labels);
+
+	/// <summary>
+	/// Labels as stored; they are checked against the graph when they are loaded.
+	/// Empty labels (none were computed) are returned as is.
+	/// </summary>
+	graph::HubLabelStorage<GraphTime> DeserializeHubLabels(const catalogue_serialize::HubLabels& object);
+
 	void SerializeTransportSystem(
 		const catalogue::TransportCatalogue& catalogue,
 		const catalogue::renderer::RendererParameters& params,
 		const RoutingSettings& routing,
+		const catalogue::StopIndex& stop_index,
+		const graph::HubLabelStorage<GraphTime>& hub_labels,
 		std::ostream& output);
 
 	catalogue::TransportCatalogue DeserializeTransportSystem(
 		catalogue::renderer::RendererParameters& params,
 		RoutingSettings& routing,
+		catalogue::StopIndex& stop_index,
+		graph::HubLabelStorage<GraphTime>& hub_labels,
 		std::istream& input);
 	
 }
\ No newline at end of file
@@ -0,0 +1,546 @@
+#include "server.h"
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+namespace catalogue {
+
+	namespace server {
+
+		namespace {
+
+			bool IsLengthLine(const std::string& line) {
+				return !line.empty() && std::all_of(line.begin(), line.end(), [](unsigned char c) { return std::isdigit(c); });
+			}
+
+			/// <summary>
+			/// Byte count of a length line, invalid_argument if it does not fit or is above MAX_FRAME_SIZE.
+			/// </summary>
+			size_t ParseFrameLength(const std::string& line) {
+				using namespace std::literals;
+				size_t size = 0;
+				const char* end = line.data() + line.size();
+				const auto [last, error] = std::from_chars(line.data(), end, size);
+				if (error != std::errc() || last != end || size > MAX_FRAME_SIZE) {
+					throw std::invalid_argument("Malformed frame: document length "s + line.substr(0, 32)
+						+ " is above the limit of "s + std::to_string(MAX_FRAME_SIZE) + " bytes"s);
+				}
+				return size;
+			}
+
+			json::Node ErrorResponse(const std::string& message) {
+				using namespace std::literals;
+				return json::Dict{ { "error_message"s, message } };
+			}
+
+			sockaddr_un MakeAddress(const std::string& socket_path) {
+				using namespace std::literals;
+				sockaddr_un address{};
+				address.sun_family = AF_UNIX;
+				if (socket_path.size() >= sizeof(address.sun_path)) {
+					throw std::invalid_argument("Socket path is too long: "s + socket_path);
+				}
+				std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+				return address;
+			}
+
+			int OpenListeningSocket(const std::string& socket_path) {
+				using namespace std::literals;
+				sockaddr_un address = MakeAddress(socket_path);
+				int listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+				if (listen_fd < 0) {
+					throw std::runtime_error("socket: "s + std::strerror(errno));
+				}
+				::unlink(socket_path.c_str());
+				if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+					|| ::listen(listen_fd, SOMAXCONN) < 0) {
+					std::string error = std::strerror(errno);
+					::close(listen_fd);
+					throw std::runtime_error("Cannot listen on "s + socket_path + ": "s + error);
+				}
+				return listen_fd;
+			}
+
+			int ConnectSocket(const std::string& socket_path) {
+				using namespace std::literals;
+				sockaddr_un address = MakeAddress(socket_path);
+				int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+				if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+					std::string error = std::strerror(errno);
+					if (fd >= 0) {
+						::close(fd);
+					}
+					throw std::runtime_error("Cannot connect to "s + socket_path + ": "s + error);
+				}
+				return fd;
+			}
+
+
+			/// <summary>
+			/// State of one client connection of the event loop.
+			/// </summary>
+			struct Connection {
+				int fd = -1;
+				FrameDecoder decoder;
+				//response bytes not yet accepted by the socket
+				std::string output;
+				//documents given to the workers and not yet answered
+				size_t in_flight = 0;
+				//the client has shut down its sending side
+				bool read_closed = false;
+				bool broken = false;
+				//events the fd is currently registered for
+				uint32_t events = EPOLLIN;
+			};
+
+			/// <summary>
+			/// epoll loop: accepts connections, decodes documents, hands them to the worker pool and
+			/// writes the answers back. Workers report answers through a queue + eventfd.
+			/// </summary>
+			class EventLoop {
+			public:
+				EventLoop(int listen_fd, const DocumentHandler& handler, size_t worker_count)
+					: listen_fd_(listen_fd)
+					, handler_(handler)
+					, epoll_fd_(::epoll_create1(EPOLL_CLOEXEC))
+					, wake_fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+					, pool_(std::max<size_t>(1, worker_count)) {
+					using namespace std::literals;
+					if (epoll_fd_ < 0 || wake_fd_ < 0) {
+						throw std::runtime_error("epoll/eventfd: "s + std::strerror(errno));
+					}
+					Register(listen_fd_, LISTEN_ID, EPOLLIN);
+					Register(wake_fd_, WAKE_ID, EPOLLIN);
+				}
+
+				~EventLoop() {
+					for (auto& [id, connection] : connections_) {
+						::close(connection.fd);
+					}
+					::close(wake_fd_);
+					::close(epoll_fd_);
+				}
+
+				void Run() {
+					epoll_event events[64];
+					while (true) {
+						int count = ::epoll_wait(epoll_fd_, events, 64, -1);
+						if (count < 0) {
+							if (errno == EINTR) {
+								continue;
+							}
+							return;
+						}
+						for (int i = 0; i < count; ++i) {
+							const uint64_t id = events[i].data.u64;
+							if (id == LISTEN_ID) {
+								AcceptConnections();
+							}
+							else if (id == WAKE_ID) {
+								DeliverAnswers();
+							}
+							else {
+								HandleConnectionEvent(id, events[i].events);
+							}
+						}
+					}
+				}
+
+			private:
+				static constexpr uint64_t LISTEN_ID = 0;
+				static constexpr uint64_t WAKE_ID = 1;
+
+				void Register(int fd, uint64_t id, uint32_t events) {
+					epoll_event event{};
+					event.events = events;
+					event.data.u64 = id;
+					::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+				}
+
+				void AcceptConnections() {
+					while (true) {
+						int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+						if (fd < 0) {
+							if (errno == EINTR) {
+								continue;
+							}
+							return;
+						}
+						const uint64_t id = next_id_++;
+						Connection connection;
+						connection.fd = fd;
+						connections_.emplace(id, std::move(connection));
+						Register(fd, id, EPOLLIN);
+					}
+				}
+
+				void HandleConnectionEvent(uint64_t id, uint32_t events) {
+					auto it = connections_.find(id);
+					if (it == connections_.end()) {
+						return;
+					}
+					Connection& connection = it->second;
+					if (events & (EPOLLHUP | EPOLLERR)) {
+						//both directions are closed: answers can't be delivered anymore
+						connection.broken = true;
+					}
+					else if (events & EPOLLIN) {
+						ReadDocuments(id, connection);
+					}
+					if (events & EPOLLOUT) {
+						Flush(connection);
+					}
+					Update(it);
+				}
+
+				void ReadDocuments(uint64_t id, Connection& connection) {
+					char buffer[16384];
+					while (!connection.read_closed) {
+						ssize_t count = ::read(connection.fd, buffer, sizeof(buffer));
+						if (count > 0) {
+							connection.decoder.Append(buffer, count);
+							//decoded as it arrives: the buffer stays within one frame
+							SubmitDocuments(id, connection);
+						}
+						else if (count == 0) {
+							connection.read_closed = true;
+						}
+						else if (errno == EINTR) {
+							continue;
+						}
+						else {
+							if (errno != EAGAIN && errno != EWOULDBLOCK) {
+								connection.broken = true;
+							}
+							break;
+						}
+					}
+				}
+
+				/// <summary>
+				/// Hand the complete documents to the workers. A malformed frame is answered with an error
+				/// and ends the reading: the rest of the stream can't be framed.
+				/// </summary>
+				void SubmitDocuments(uint64_t id, Connection& connection) {
+					Framing framing = Framing::NEWLINE;
+					std::string document;
+					while (true) {
+						try {
+							if (!connection.decoder.Next(framing, document)) {
+								return;
+							}
+						}
+						catch (const std::invalid_argument& e) {
+							connection.output += EncodeFrame(framing, ErrorResponse(e.what()));
+							connection.read_closed = true;
+							Flush(connection);
+							return;
+						}
+						++connection.in_flight;
+						pool_.Submit([this, id, framing, document = std::move(document)]() {
+							std::string bytes = EncodeFrame(framing, AnswerDocument(document, handler_));
+							{
+								std::lock_guard lock(answers_mutex_);
+								answers_.emplace_back(id, std::move(bytes));
+							}
+							const uint64_t one = 1;
+							[[maybe_unused]] ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+						});
+					}
+				}
+
+				void DeliverAnswers() {
+					uint64_t counter;
+					[[maybe_unused]] ssize_t count = ::read(wake_fd_, &counter, sizeof(counter));
+
+					std::vector<std::pair<uint64_t, std::string>> answers;
+					{
+						std::lock_guard lock(answers_mutex_);
+						answers.swap(answers_);
+					}
+					for (auto& [id, bytes] : answers) {
+						auto it = connections_.find(id);
+						if (it == connections_.end()) {
+							//the client is gone
+							continue;
+						}
+						--it->second.in_flight;
+						it->second.output += bytes;
+						Flush(it->second);
+						Update(it);
+					}
+				}
+
+				void Flush(Connection& connection) {
+					size_t sent = 0;
+					while (sent < connection.output.size()) {
+						ssize_t count = ::send(connection.fd, connection.output.data() + sent,
+							connection.output.size() - sent, MSG_NOSIGNAL);
+						if (count > 0) {
+							sent += count;
+						}
+						else if (count < 0 && errno == EINTR) {
+							continue;
+						}
+						else {
+							if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+								connection.broken = true;
+							}
+							break;
+						}
+					}
+					connection.output.erase(0, sent);
+				}
+
+				/// <summary>
+				/// Close the connection when it is done, otherwise adjust the events it waits for.
+				/// </summary>
+				void Update(std::unordered_map<uint64_t, Connection>::iterator it) {
+					Connection& connection = it->second;
+					const bool finished = connection.read_closed && connection.in_flight == 0 && connection.output.empty();
+					if (connection.broken || finished) {
+						::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection.fd, nullptr);
+						::close(connection.fd);
+						connections_.erase(it);
+						return;
+					}
+					const uint32_t events = (connection.read_closed ? 0u : static_cast<uint32_t>(EPOLLIN))
+						| (connection.output.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+					if (events != connection.events) {
+						epoll_event event{};
+						event.events = events;
+						event.data.u64 = it->first;
+						::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+						connection.events = events;
+					}
+				}
+
+				int listen_fd_;
+				const DocumentHandler& handler_;
+				int epoll_fd_;
+				int wake_fd_;
+				uint64_t next_id_ = WAKE_ID + 1;
+				std::unordered_map<uint64_t, Connection> connections_;
+
+				std::mutex answers_mutex_;
+				std::vector<std::pair<uint64_t, std::string>> answers_;
+
+				//declared last: workers are joined before the rest of the loop is destroyed
+				parallel::ThreadPool pool_;
+			};
+
+		}
+
+
+		void FrameDecoder::Append(const char* data, size_t size) {
+			buffer_.append(data, size);
+		}
+
+		bool FrameDecoder::Next(Framing& framing, std::string& document) {
+			using namespace std::literals;
+			while (true) {
+				if (body_size_) {
+					if (buffer_.size() - position_ < *body_size_) {
+						break;
+					}
+					document = buffer_.substr(position_, *body_size_);
+					position_ += *body_size_;
+					body_size_.reset();
+					framing = Framing::LENGTH;
+					return true;
+				}
+
+				const size_t end_of_line = buffer_.find('\n', position_);
+				if (end_of_line == std::string::npos) {
+					//the line of a document or of a length can't get longer than the largest document
+					if (buffer_.size() - position_ > MAX_FRAME_SIZE) {
+						framing = Framing::NEWLINE;
+						throw std::invalid_argument("Malformed frame: a line is longer than "s + std::to_string(MAX_FRAME_SIZE) + " bytes"s);
+					}
+					break;
+				}
+				std::string line = buffer_.substr(position_, end_of_line - position_);
+				position_ = end_of_line + 1;
+				if (!line.empty() && line.back() == '\r') {
+					line.pop_back();
+				}
+				if (line.empty()) {
+					continue;
+				}
+				if (IsLengthLine(line)) {
+					framing = Framing::LENGTH;
+					body_size_ = ParseFrameLength(line);
+					continue;
+				}
+				document = std::move(line);
+				framing = Framing::NEWLINE;
+				return true;
+			}
+			//drop the consumed bytes, keep the incomplete tail
+			buffer_.erase(0, position_);
+			position_ = 0;
+			return false;
+		}
+
+
+		std::string EncodeFrame(Framing framing, const json::Node& response) {
+			if (framing == Framing::NEWLINE) {
+				return json::PrintCompact(response) + '\n';
+			}
+			std::string body = json::Print(response);
+			return std::to_string(body.size()) + '\n' + body;
+		}
+
+
+		void WriteFrame(std::ostream& output, Framing framing, const json::Node& response) {
+			output << EncodeFrame(framing, response);
+			output.flush();
+		}
+
+
+		json::Node AnswerDocument(const std::string& document, const DocumentHandler& handler) {
+			try {
+				return handler(json::LoadJSON(document).GetRoot());
+			}
+			catch (const std::exception& e) {
+				return ErrorResponse(e.what());
+			}
+		}
+
+
+		void ServeStream(std::istream& input, std::ostream& output, const DocumentHandler& handler) {
+			std::string line;
+			while (std::getline(input, line)) {
+				if (!line.empty() && line.back() == '\r') {
+					line.pop_back();
+				}
+				if (line.empty()) {
+					continue;
+				}
+
+				if (IsLengthLine(line)) {
+					size_t size = 0;
+					try {
+						size = ParseFrameLength(line);
+					}
+					catch (const std::invalid_argument& e) {
+						//where the body ends is unknown: the next lines are taken as documents
+						WriteFrame(output, Framing::LENGTH, ErrorResponse(e.what()));
+						continue;
+					}
+					std::string document(size, '\0');
+					input.read(document.data(), document.size());
+					if (static_cast<size_t>(input.gcount()) != document.size()) {
+						break;
+					}
+					WriteFrame(output, Framing::LENGTH, AnswerDocument(document, handler));
+				}
+				else {
+					WriteFrame(output, Framing::NEWLINE, AnswerDocument(line, handler));
+				}
+			}
+		}
+
+
+		void ServeUnixSocket(const std::string& socket_path, const DocumentHandler& handler, size_t worker_count) {
+			int listen_fd = OpenListeningSocket(socket_path);
+			{
+				EventLoop loop(listen_fd, handler, worker_count);
+				loop.Run();
+			}
+			::close(listen_fd);
+		}
+
+
+		void RunLoadTest(const std::string& socket_path, size_t connection_count, std::istream& requests, std::ostream& report) {
+			std::vector<std::string> lines;
+			std::string line;
+			while (std::getline(requests, line)) {
+				if (!line.empty()) {
+					lines.push_back(line + '\n');
+				}
+			}
+			connection_count = std::max<size_t>(connection_count, 1);
+
+			std::atomic<size_t> answered = 0;
+			//connections that could not be opened, their requests are not sent
+			std::atomic<size_t> failed = 0;
+			std::mutex error_mutex;
+			std::string first_error;
+			const auto start = std::chrono::steady_clock::now();
+			std::vector<std::thread> clients;
+			for (size_t c = 0; c < connection_count; ++c) {
+				clients.emplace_back([&, c]() {
+					int fd = -1;
+					try {
+						fd = ConnectSocket(socket_path);
+					}
+					catch (const std::runtime_error& error) {
+						++failed;
+						std::lock_guard lock(error_mutex);
+						if (first_error.empty()) {
+							first_error = error.what();
+						}
+						return;
+					}
+					//all requests of the connection are sent without waiting for the answers
+					std::thread writer([&]() {
+						for (size_t i = c; i < lines.size(); i += connection_count) {
+							const std::string& request = lines[i];
+							size_t sent = 0;
+							while (sent < request.size()) {
+								ssize_t count = ::send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+								if (count <= 0) {
+									return;
+								}
+								sent += count;
+							}
+						}
+						::shutdown(fd, SHUT_WR);
+					});
+					char buffer[16384];
+					ssize_t count;
+					while ((count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+						answered += std::count(buffer, buffer + count, '\n');
+					}
+					writer.join();
+					::close(fd);
+				});
+			}
+			for (auto& client : clients) {
+				client.join();
+			}
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			report << lines.size() << " requests, " << answered.load() << " answers over " << connection_count
+				<< " connections in " << elapsed.count() * 1000 << " ms ("
+				<< (elapsed.count() > 0 ? lines.size() / elapsed.count() : 0) << " requests/s)";
+			if (failed > 0) {
+				report << ", " << failed.load() << " connections failed (" << first_error << ")";
+			}
+			report << std::endl;
+		}
+
+	}
+
+}
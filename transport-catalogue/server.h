@@ -0,0 +1,98 @@
+#pragma once
+
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include "json.h"
+
+
+namespace catalogue {
+
+	namespace server {
+
+		/// <summary>
+		/// How a document was delimited in the input stream. The response uses the same framing.
+		/// NEWLINE: one document per line, response is printed on one line.
+		/// LENGTH: a line with the byte count of the document, then the document itself,
+		/// response is "<byte count>\n<document>".
+		/// </summary>
+		enum class Framing {
+			NEWLINE,
+			LENGTH
+		};
+
+		/// <summary>
+		/// Largest document accepted, in bytes. A longer length line is a malformed frame:
+		/// it is rejected before anything is allocated for the document.
+		/// </summary>
+		inline const size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+		/// <summary>
+		/// Turns a request document into a response document.
+		/// </summary>
+		using DocumentHandler = std::function<json::Node(const json::Node& document)>;
+
+
+		/// <summary>
+		/// Cuts a byte stream (as it arrives from a non-blocking socket) into documents.
+		/// A line of digits only is a length line: a request document is a JSON object, never a bare number.
+		/// </summary>
+		class FrameDecoder {
+		public:
+			void Append(const char* data, size_t size);
+
+			/// <summary>
+			/// Extract the next complete document. Return false if more bytes are needed.
+			/// invalid_argument for a malformed frame (a length above MAX_FRAME_SIZE, a longer line),
+			/// framing is then the one of that frame.
+			/// </summary>
+			bool Next(Framing& framing, std::string& document);
+
+		private:
+			std::string buffer_;
+			size_t position_ = 0;
+			//size of the document body if its length line has already been read
+			std::optional<size_t> body_size_;
+		};
+
+
+		/// <summary>
+		/// Response bytes with the given framing.
+		/// </summary>
+		std::string EncodeFrame(Framing framing, const json::Node& response);
+
+		/// <summary>
+		/// Write the response to output with the given framing.
+		/// </summary>
+		void WriteFrame(std::ostream& output, Framing framing, const json::Node& response);
+
+		/// <summary>
+		/// Parse one document and answer it. Malformed documents get an "error_message" response.
+		/// </summary>
+		json::Node AnswerDocument(const std::string& document, const DocumentHandler& handler);
+
+		/// <summary>
+		/// Read framed documents from input until EOF, answer each one as soon as it is read.
+		/// A bad length line gets an "error_message" response; the lines after it are read as documents.
+		/// </summary>
+		void ServeStream(std::istream& input, std::ostream& output, const DocumentHandler& handler);
+
+		/// <summary>
+		/// Listen on a Unix domain socket with a single epoll (non-blocking) event loop.
+		/// Every document of every connection is answered by a pool of worker_count threads (at least one);
+		/// a client can pipeline many documents, responses are written back as soon as they
+		/// complete, so they can come out of order (each answer carries its request_id).
+		/// </summary>
+		void ServeUnixSocket(const std::string& socket_path, const DocumentHandler& handler, size_t worker_count);
+
+		/// <summary>
+		/// Localhost load generator: send every non-empty line of requests (one document per line)
+		/// over connection_count pipelined connections, wait for all responses and write the throughput to report,
+		/// with the number of connections that could not be opened.
+		/// </summary>
+		void RunLoadTest(const std::string& socket_path, size_t connection_count, std::istream& requests, std::ostream& report);
+
+	}
+
+}
@@ -0,0 +1,180 @@
+#define _USE_MATH_DEFINES
+#include "stop_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+namespace catalogue {
+
+	namespace {
+
+		double SquaredChord(const std::array<double, 3>& lhs, const std::array<double, 3>& rhs) {
+			double result = 0;
+			for (size_t axis = 0; axis < 3; ++axis) {
+				const double diff = lhs[axis] - rhs[axis];
+				result += diff * diff;
+			}
+			return result;
+		}
+
+		/// <summary>
+		/// Squared chord (on the unit sphere) of a great-circle distance in meters.
+		/// </summary>
+		double SquaredChordOfDistance(double distance) {
+			if (distance >= M_PI * geo::EARTH_RADIUS) {
+				return 4;
+			}
+			const double chord = 2 * std::sin(distance / (2 * geo::EARTH_RADIUS));
+			//small margin: the exact distance is checked for the found stops
+			return chord * chord * (1 + 1e-9) + 1e-18;
+		}
+
+	}
+
+	StopIndex::StopIndex(const StopColumns& stops) {
+		for (size_t id = 0; id < stops.size(); ++id) {
+			points_.push_back(ToPoint(stops.GetCoordinates(id)));
+		}
+		order_.resize(stops.size());
+		std::iota(order_.begin(), order_.end(), 0);
+		axes_.resize(stops.size());
+		Build(0, order_.size());
+	}
+
+	StopIndex::StopIndex(const StopColumns& stops, std::vector<uint32_t> order, std::vector<uint8_t> axes)
+		: order_(std::move(order))
+		, axes_(std::move(axes)) {
+		if (order_.size() != stops.size() || axes_.size() != stops.size()) {
+			throw std::invalid_argument("Stop index does not match the stops");
+		}
+		for (size_t id = 0; id < stops.size(); ++id) {
+			points_.push_back(ToPoint(stops.GetCoordinates(id)));
+		}
+		//order must be a permutation of the stops
+		std::vector<bool> seen(stops.size(), false);
+		for (size_t i = 0; i < order_.size(); ++i) {
+			if (order_[i] >= stops.size() || seen[order_[i]] || axes_[i] > 2) {
+				throw std::invalid_argument("Stop index does not match the stops");
+			}
+			seen[order_[i]] = true;
+		}
+	}
+
+	StopIndex::Point StopIndex::ToPoint(geo::Coordinates coordinates) {
+		static const double dr = M_PI / 180.;
+		const double lat = coordinates.lat * dr;
+		const double lng = coordinates.lng * dr;
+		return { std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng), std::sin(lat) };
+	}
+
+	void StopIndex::Build(size_t begin, size_t end) {
+		if (begin >= end) {
+			return;
+		}
+		//split along the axis with the widest spread
+		Point low = points_[order_[begin]];
+		Point high = low;
+		for (size_t i = begin; i < end; ++i) {
+			const Point& point = points_[order_[i]];
+			for (size_t axis = 0; axis < 3; ++axis) {
+				low[axis] = std::min(low[axis], point[axis]);
+				high[axis] = std::max(high[axis], point[axis]);
+			}
+		}
+		uint8_t split = 0;
+		for (uint8_t axis = 1; axis < 3; ++axis) {
+			if (high[axis] - low[axis] > high[split] - low[split]) {
+				split = axis;
+			}
+		}
+
+		const size_t middle = begin + (end - begin) / 2;
+		std::nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end,
+			[this, split](uint32_t lhs, uint32_t rhs) { return points_[lhs][split] < points_[rhs][split]; });
+		axes_[middle] = split;
+
+		Build(begin, middle);
+		Build(middle + 1, end);
+	}
+
+	void StopIndex::Search(size_t begin, size_t end, const Point& target, size_t count, double& bound,
+		std::vector<std::pair<double, size_t>>& best) const {
+		if (begin >= end) {
+			return;
+		}
+		const size_t middle = begin + (end - begin) / 2;
+		const Point& point = points_[order_[middle]];
+
+		const double squared = SquaredChord(point, target);
+		if (squared <= bound) {
+			best.emplace_back(squared, order_[middle]);
+			std::push_heap(best.begin(), best.end());
+			if (best.size() > count) {
+				std::pop_heap(best.begin(), best.end());
+				best.pop_back();
+			}
+			if (best.size() == count) {
+				bound = std::min(bound, best.front().first);
+			}
+		}
+
+		const uint8_t axis = axes_[middle];
+		const double diff = target[axis] - point[axis];
+		if (diff < 0) {
+			Search(begin, middle, target, count, bound, best);
+			if (diff * diff <= bound) {
+				Search(middle + 1, end, target, count, bound, best);
+			}
+		}
+		else {
+			Search(middle + 1, end, target, count, bound, best);
+			if (diff * diff <= bound) {
+				Search(begin, middle, target, count, bound, best);
+			}
+		}
+	}
+
+	std::vector<StopDistance> StopIndex::FindNearest(geo::Coordinates point, size_t count, double radius) const {
+		std::vector<StopDistance> result;
+		if (count == 0 || order_.empty() || radius < 0) {
+			return result;
+		}
+
+		//max-heap of (squared chord, stop_id): the farthest kept stop on top
+		std::vector<std::pair<double, size_t>> best;
+		double bound = SquaredChordOfDistance(radius);
+		Search(0, order_.size(), ToPoint(point), count, bound, best);
+
+		for (const auto& [squared, stop_id] : best) {
+			//great-circle distance from the chord: stable for very close points, unlike acos
+			const double distance = 2 * geo::EARTH_RADIUS * std::asin(std::min(1.0, std::sqrt(squared) / 2));
+			if (distance <= radius) {
+				result.push_back({ stop_id, distance });
+			}
+		}
+		std::sort(result.begin(), result.end(), [](const StopDistance& lhs, const StopDistance& rhs) {
+			return std::tie(lhs.distance, lhs.stop_id) < std::tie(rhs.distance, rhs.stop_id);
+		});
+		return result;
+	}
+
+	std::vector<StopDistance> StopIndex::FindWithin(geo::Coordinates point, double radius) const {
+		return FindNearest(point, order_.size(), radius);
+	}
+
+	size_t StopIndex::GetSize() const {
+		return order_.size();
+	}
+
+	const std::vector<uint32_t>& StopIndex::GetOrder() const {
+		return order_;
+	}
+
+	const std::vector<uint8_t>& StopIndex::GetAxes() const {
+		return axes_;
+	}
+
+}
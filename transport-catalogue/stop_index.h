@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "domain.h"
+
+namespace catalogue {
+
+	/// <summary>
+	/// A stop (its Stop::id) and its distance in meters.
+	/// </summary>
+	struct StopDistance {
+		size_t stop_id;
+		double distance;
+	};
+
+	/// <summary>
+	/// Static k-d tree over the stops' coordinates.
+	/// Coordinates are points on the unit sphere (x, y, z): the straight-line distance between
+	/// such points grows with the great-circle distance, so the tree prunes exactly.
+	/// The tree is stored implicitly: for a range of the order, the middle element is the node
+	/// and the left/right halves are its subtrees. Order and split axes are enough to restore it.
+	/// Stops added to the catalogue after the index is built are not indexed.
+	/// </summary>
+	class StopIndex {
+	public:
+		StopIndex() = default;
+
+		/// <summary>
+		/// Build the tree over all the stops.
+		/// </summary>
+		explicit StopIndex(const StopColumns& stops);
+
+		/// <summary>
+		/// Restore a tree built before (as given by GetOrder() and GetAxes()).
+		/// Throws std::invalid_argument if the layout does not match the stops.
+		/// </summary>
+		StopIndex(const StopColumns& stops, std::vector<uint32_t> order, std::vector<uint8_t> axes);
+
+		/// <summary>
+		/// At most count stops closest to point and not farther than radius (meters), closest first.
+		/// </summary>
+		std::vector<StopDistance> FindNearest(geo::Coordinates point, size_t count,
+			double radius = std::numeric_limits<double>::infinity()) const;
+
+		/// <summary>
+		/// All stops not farther than radius (meters) from point, closest first.
+		/// </summary>
+		std::vector<StopDistance> FindWithin(geo::Coordinates point, double radius) const;
+
+		size_t GetSize() const;
+
+		const std::vector<uint32_t>& GetOrder() const;
+
+		const std::vector<uint8_t>& GetAxes() const;
+
+	private:
+		using Point = std::array<double, 3>;
+
+		static Point ToPoint(geo::Coordinates coordinates);
+
+		void Build(size_t begin, size_t end);
+
+		void Search(size_t begin, size_t end, const Point& target, size_t count, double& bound,
+			std::vector<std::pair<double, size_t>>& best) const;
+
+		//points of the stops by stop_id
+		std::vector<Point> points_;
+		//stop_id of the tree nodes
+		std::vector<uint32_t> order_;
+		//split axis of the tree nodes
+		std::vector<uint8_t> axes_;
+	};
+
+}
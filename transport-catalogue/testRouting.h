@@ -0,0 +1,740 @@
+#pragma once
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "csa.h"
+#include "hub_labels.h"
+#include "lru_cache.h"
+#include "radix_heap.h"
+#include "raptor.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+namespace catalogue {
+
+    namespace test {
+
+        /// <summary>
+        /// A-B-C straight line (1000m, 2000m) + round bus A>C>A (5000m each way).
+        /// </summary>
+        void FillSmallNetwork(TransportCatalogue& tc) {
+            tc.AddStop("A", { 55.60, 37.20 });
+            tc.AddStop("B", { 55.61, 37.21 });
+            tc.AddStop("C", { 55.62, 37.22 });
+            tc.AddStop("D", { 55.63, 37.23 });
+
+            tc.AddNearestStops("A", "B", 1000);
+            tc.AddNearestStops("B", "C", 2000);
+            tc.AddNearestStops("A", "C", 5000);
+
+            tc.AddBus("line", { "A","B","C" }, RouteKind::STRAIGHT);
+            tc.AddBus("ring", { "A","C","A" }, RouteKind::ROUND_TRIP);
+        }
+
+        void TestLruCache() {
+            cache::LruCache<int, std::string> lru(2);
+            lru.Put(1, "one");
+            lru.Put(2, "two");
+            assert(lru.Get(1) == "one");
+            //2 is the least recently used now
+            lru.Put(3, "three");
+            assert(!lru.Get(2));
+            assert(lru.Get(3) == "three");
+            assert(lru.Get(1) == "one");
+
+            cache::CacheStats stats = lru.GetStats();
+            assert(stats.hits == 3);
+            assert(stats.misses == 1);
+            assert(stats.size == 2);
+            assert(stats.capacity == 2);
+
+            cache::LruCache<int, int> disabled(0);
+            disabled.Put(1, 1);
+            assert(!disabled.Get(1));
+        }
+
+        void TestRouteCache() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            TransportGraphWrapper graph(RoutingSettings{ 60, 2 }, tc);
+            graph.BuildTransportGraph();
+
+            auto first = graph.FindRoute({ tc.FindStop("A"), tc.FindStop("C") });
+            auto second = graph.FindRoute({ tc.FindStop("A"), tc.FindStop("C") });
+            assert(first->rout_exists);
+            //60 km/h => 1 min per km: wait 2 + 3 km on "line"
+            assert(std::abs(first->total_time - 5.0) < 1e-9);
+            assert(first == second);
+
+            //D is on no bus: answered without search and cache
+            auto no_route = graph.FindRoute({ tc.FindStop("A"), tc.FindStop("D") });
+            assert(!no_route->rout_exists);
+
+            auto back = graph.FindRoute({ tc.FindStop("C"), tc.FindStop("A") });
+            assert(back->rout_exists);
+
+            cache::CacheStats stats = graph.GetRouteCacheStats();
+            assert(stats.hits == 1);
+            assert(stats.misses == 2);
+            assert(stats.size == 2);
+        }
+
+        void TestRoutesFromOrigin() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            TransportGraphWrapper all_pairs(RoutingSettings{ 60, 2 }, tc);
+            all_pairs.BuildTransportGraph();
+            TransportGraphWrapper per_query(RoutingSettings{ 60, 2, RouterMode::PER_QUERY }, tc);
+            per_query.BuildTransportGraph();
+
+            const std::vector<Stop*> to = { tc.FindStop("A"), tc.FindStop("B"), tc.FindStop("C"), tc.FindStop("D"), tc.FindStop("C") };
+            for (Stop* from : { tc.FindStop("A"), tc.FindStop("B"), tc.FindStop("C") }) {
+                auto expected = all_pairs.FindRoutesFromOrigin(from, to);
+                auto actual = per_query.FindRoutesFromOrigin(from, to);
+                assert(actual.size() == to.size());
+                for (size_t i = 0; i < to.size(); ++i) {
+                    assert(actual[i]->rout_exists == expected[i]->rout_exists);
+                    assert(std::abs(actual[i]->total_time - expected[i]->total_time) < 1e-9);
+                    assert(actual[i]->items.size() == expected[i]->items.size());
+                }
+            }
+            //3 origins x 3 stops on buses; D is not cached and the repeated C is one entry
+            assert(per_query.GetRouteCacheStats().size == 9);
+        }
+
+        void TestTravelTimeMatrix() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            TransportGraphWrapper graph(RoutingSettings{ 60, 2 }, tc);
+            graph.BuildTransportGraph();
+
+            const std::vector<Stop*> stops = { tc.FindStop("A"), tc.FindStop("B"), tc.FindStop("C"), tc.FindStop("D"), nullptr };
+            for (size_t threads : { 1, 4 }) {
+                auto times = graph.ComputeTravelTimes(stops, stops, threads);
+                assert(times.size() == stops.size());
+                for (size_t i = 0; i < stops.size(); ++i) {
+                    assert(times[i].size() == stops.size());
+                    for (size_t j = 0; j < stops.size(); ++j) {
+                        auto route = graph.FindRoute({ stops[i], stops[j] });
+                        assert(times[i][j].has_value() == route->rout_exists);
+                        if (times[i][j]) {
+                            assert(std::abs(*times[i][j] - route->total_time) < 1e-9);
+                        }
+                    }
+                }
+            }
+        }
+
+        void TestReachableStops() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            TransportGraphWrapper graph(RoutingSettings{ 60, 2 }, tc);
+            graph.BuildTransportGraph();
+
+            //A at 0, B at 2+1, C at 2+3 (via B on "line")
+            auto reachable = graph.FindReachableStops(tc.FindStop("A"), 4.0);
+            assert(reachable.size() == 2);
+            assert(reachable[0].first == tc.FindStop("A") && reachable[0].second == 0);
+            assert(reachable[1].first == tc.FindStop("B") && std::abs(reachable[1].second - 3.0) < 1e-9);
+
+            //bus times are computed from m/min, allow for rounding
+            reachable = graph.FindReachableStops(tc.FindStop("A"), 5.0 + 1e-9);
+            assert(reachable.size() == 3);
+            assert(reachable[2].first == tc.FindStop("C") && std::abs(reachable[2].second - 5.0) < 1e-9);
+
+            //D is on no bus
+            assert(graph.FindReachableStops(tc.FindStop("D"), 100).empty());
+        }
+
+        void TestRouteBetweenPoints() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            RoutingSettings settings{ 60, 2 };
+            settings.walk_velocity = 6;
+            settings.walk_radius = 200;
+            TransportGraphWrapper graph(settings, tc);
+            graph.BuildTransportGraph();
+
+            //100 m at 6 km/h = 1 min
+            auto route = graph.FindRouteBetweenPoints(
+                { { tc.FindStop("A"), 100 }, { tc.FindStop("D"), 50 } },
+                { { tc.FindStop("C"), 100 } },
+                5000);
+            assert(route.rout_exists);
+            assert(std::abs(route.total_time - (1 + 5 + 1)) < 1e-9);
+            assert(route.items.size() == 4);
+            assert(std::get<WalkItem>(route.items.front()).to_stop == "A");
+            assert(std::get<WalkItem>(route.items.back()).from_stop == "C");
+
+            //walking the whole way is faster
+            route = graph.FindRouteBetweenPoints({ { tc.FindStop("A"), 100 } }, { { tc.FindStop("C"), 100 } }, 150);
+            assert(route.rout_exists && route.items.size() == 1);
+            assert(std::abs(route.total_time - 1.5) < 1e-9);
+
+            //no stop near the destination and too far to walk
+            route = graph.FindRouteBetweenPoints({ { tc.FindStop("A"), 100 } }, {}, 5000);
+            assert(!route.rout_exists);
+        }
+
+        void TestRideVerticesModel() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            TransportGraphWrapper stop_pairs(RoutingSettings{ 60, 2 }, tc);
+            stop_pairs.BuildTransportGraph();
+            RoutingSettings settings{ 60, 2, RouterMode::PER_QUERY };
+            settings.graph_model = GraphModel::RIDE_VERTICES;
+            TransportGraphWrapper ride_vertices(settings, tc);
+            ride_vertices.BuildTransportGraph();
+
+            for (const char* from : { "A", "B", "C", "D" }) {
+                for (const char* to : { "A", "B", "C", "D" }) {
+                    auto expected = stop_pairs.FindRoute({ tc.FindStop(from), tc.FindStop(to) });
+                    auto actual = ride_vertices.FindRoute({ tc.FindStop(from), tc.FindStop(to) });
+                    assert(actual->rout_exists == expected->rout_exists);
+                    assert(std::abs(actual->total_time - expected->total_time) < 1e-9);
+                    assert(actual->items.size() == expected->items.size());
+                }
+            }
+
+            //A => C rides 2 spans of "line" in one BusItem
+            auto route = ride_vertices.FindRoute({ tc.FindStop("A"), tc.FindStop("C") });
+            const BusItem& bus = std::get<BusItem>(route->items.at(1));
+            assert(bus.bus_name == "line" && bus.span_count == 2);
+            assert(std::abs(bus.time - 3.0) < 1e-9);
+        }
+
+        void TestRoutingOverride() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            TransportGraphWrapper graph(RoutingSettings{ 60, 2 }, tc);
+            graph.BuildTransportGraph();
+            TransportGraphWrapper rebuilt(RoutingSettings{ 30, 1 }, tc);
+            rebuilt.BuildTransportGraph();
+
+            RoutingOverride slower{ 30.0, 1.0 };
+            for (const char* from : { "A", "B", "C" }) {
+                for (const char* to : { "A", "B", "C" }) {
+                    auto expected = rebuilt.FindRoute({ tc.FindStop(from), tc.FindStop(to) });
+                    auto actual = graph.FindRoute({ tc.FindStop(from), tc.FindStop(to) }, slower);
+                    assert(actual.rout_exists == expected->rout_exists);
+                    assert(std::abs(actual.total_time - expected->total_time) < 1e-9);
+                }
+            }
+            //A => C: wait 1 + 3 km at 30 km/h
+            auto route = graph.FindRoute({ tc.FindStop("A"), tc.FindStop("C") }, slower);
+            assert(std::abs(std::get<WaitItem>(route.items.at(0)).time - 1.0) < 1e-9);
+            assert(std::abs(std::get<BusItem>(route.items.at(1)).time - 6.0) < 1e-9);
+
+            //override routes are not cached
+            assert(graph.GetRouteCacheStats().size == 0);
+        }
+
+        /// <summary>
+        /// Random sparse graph with edge_count edges (weights in [0, 143)).
+        /// </summary>
+        graph::DirectedWeightedGraph<double> MakeRandomGraph(size_t vertex_count, size_t edge_count, unsigned seed) {
+            graph::DirectedWeightedGraph<double> graph(vertex_count);
+            auto next = [&seed]() {
+                seed = seed * 1103515245u + 12345u;
+                return (seed >> 8) % 100000;
+            };
+            for (size_t i = 0; i < edge_count; ++i) {
+                graph.AddEdge({ next() % vertex_count, next() % vertex_count, (next() % 1000) / 7.0 });
+            }
+            return graph;
+        }
+
+        void TestTiledRouter() {
+            //more vertexes than a tile: several rounds, partial last tile
+            const size_t vertex_count = 150;
+            const auto graph = MakeRandomGraph(vertex_count, vertex_count * 4, 7);
+
+            graph::Router<double> single(graph, graph::AllPairsAlgorithm::FLOYD_WARSHALL, 1);
+            graph::Router<double> multi(graph, graph::AllPairsAlgorithm::FLOYD_WARSHALL, 3);
+            graph::ShortestPathSearch<double> search(graph);
+            for (graph::VertexId from = 0; from < vertex_count; ++from) {
+                search.Reset();
+                search.AddSource(from);
+                search.Run();
+                for (graph::VertexId to = 0; to < vertex_count; ++to) {
+                    auto route = single.BuildRoute(from, to);
+                    auto same = multi.BuildRoute(from, to);
+                    auto expected = search.GetDistance(to);
+                    assert(route.has_value() == expected.has_value());
+                    assert(same.has_value() == route.has_value());
+                    if (route) {
+                        assert(std::abs(route->weight - *expected) < 1e-9);
+                        assert(same->weight == route->weight && same->edges == route->edges);
+                    }
+                }
+            }
+        }
+
+        void TestDijkstraAllPairs() {
+            const size_t vertex_count = 150;
+            const auto graph = MakeRandomGraph(vertex_count, vertex_count * 4, 11);
+
+            graph::Router<double> floyd(graph, graph::AllPairsAlgorithm::FLOYD_WARSHALL, 1);
+            graph::Router<double> single(graph, graph::AllPairsAlgorithm::DIJKSTRA, 1);
+            graph::Router<double> multi(graph, graph::AllPairsAlgorithm::DIJKSTRA, 3);
+            for (graph::VertexId from = 0; from < vertex_count; ++from) {
+                for (graph::VertexId to = 0; to < vertex_count; ++to) {
+                    auto expected = floyd.BuildRoute(from, to);
+                    auto route = single.BuildRoute(from, to);
+                    auto same = multi.BuildRoute(from, to);
+                    assert(route.has_value() == expected.has_value());
+                    assert(same.has_value() == route.has_value());
+                    if (!route) {
+                        continue;
+                    }
+                    assert(std::abs(route->weight - expected->weight) < 1e-9);
+                    //rows do not depend on the thread that computed them
+                    assert(same->weight == route->weight && same->edges == route->edges);
+                    //the edges form a route from -> to of the same weight
+                    graph::VertexId vertex = from;
+                    double weight = 0;
+                    for (const graph::EdgeId edge_id : route->edges) {
+                        assert(graph.GetEdge(edge_id).from == vertex);
+                        vertex = graph.GetEdge(edge_id).to;
+                        weight += graph.GetEdge(edge_id).weight;
+                    }
+                    assert(vertex == to);
+                    assert(std::abs(weight - route->weight) < 1e-9);
+                }
+            }
+        }
+
+        void TestBidirectionalSearch() {
+            const size_t vertex_count = 150;
+            const auto graph = MakeRandomGraph(vertex_count, vertex_count * 3, 13);
+
+            graph::ShortestPathSearch<double> search(graph);
+            graph::BidirectionalSearch<double> bidirectional(graph);
+            for (graph::VertexId from = 0; from < vertex_count; ++from) {
+                search.Reset();
+                search.AddSource(from);
+                search.Run();
+                for (graph::VertexId to = 0; to < vertex_count; ++to) {
+                    auto route = bidirectional.FindRoute(from, to);
+                    auto expected = search.GetDistance(to);
+                    assert(route.has_value() == expected.has_value());
+                    if (!route) {
+                        continue;
+                    }
+                    assert(std::abs(route->weight - *expected) < 1e-9);
+                    //the stitched edges are in travel order
+                    graph::VertexId vertex = from;
+                    double weight = 0;
+                    for (const graph::EdgeId edge_id : route->edges) {
+                        assert(graph.GetEdge(edge_id).from == vertex);
+                        vertex = graph.GetEdge(edge_id).to;
+                        weight += graph.GetEdge(edge_id).weight;
+                    }
+                    assert(vertex == to);
+                    assert(std::abs(weight - route->weight) < 1e-9);
+                }
+            }
+        }
+
+        void TestHubLabels() {
+            const size_t vertex_count = 150;
+            const auto graph = MakeRandomGraph(vertex_count, vertex_count * 3, 17);
+
+            const graph::HubLabels<double> labels(graph);
+            //restored labels answer the same
+            const graph::HubLabels<double> restored(graph, labels.GetStorage());
+            graph::ShortestPathSearch<double> search(graph);
+            for (graph::VertexId from = 0; from < vertex_count; ++from) {
+                search.Reset();
+                search.AddSource(from);
+                search.Run();
+                for (graph::VertexId to = 0; to < vertex_count; ++to) {
+                    auto distance = labels.GetDistance(from, to);
+                    auto expected = search.GetDistance(to);
+                    assert(distance.has_value() == expected.has_value());
+                    assert(restored.GetDistance(from, to) == distance);
+                    if (!distance) {
+                        continue;
+                    }
+                    assert(std::abs(*distance - *expected) < 1e-9);
+                    //unpacked route: edges in travel order
+                    auto route = labels.BuildRoute(from, to);
+                    graph::VertexId vertex = from;
+                    double weight = 0;
+                    for (const graph::EdgeId edge_id : route->edges) {
+                        assert(graph.GetEdge(edge_id).from == vertex);
+                        vertex = graph.GetEdge(edge_id).to;
+                        weight += graph.GetEdge(edge_id).weight;
+                    }
+                    assert(vertex == to);
+                    assert(std::abs(weight - *distance) < 1e-9);
+                }
+            }
+
+            //labels of another graph are rejected
+            bool thrown = false;
+            try {
+                graph::HubLabels<double>(MakeRandomGraph(vertex_count + 1, vertex_count, 17), labels.GetStorage());
+            }
+            catch (const std::invalid_argument&) {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+
+        void TestTravelTime() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            TransportGraphWrapper graph(RoutingSettings{ 60, 2 }, tc);
+            graph.BuildTransportGraph();
+            TransportGraphWrapper labeled(RoutingSettings{ 60, 2 }, tc);
+            labeled.BuildTransportGraph();
+            labeled.BuildHubLabels();
+            //a graph built again has the same vertexes and edges: stored labels stay valid
+            TransportGraphWrapper loaded(RoutingSettings{ 60, 2 }, tc);
+            loaded.BuildTransportGraph();
+            loaded.LoadHubLabels(labeled.GetHubLabels()->GetStorage());
+
+            for (const char* from : { "A", "B", "C" }) {
+                for (const char* to : { "A", "B", "C" }) {
+                    RouteRequest request{ tc.FindStop(from), tc.FindStop(to) };
+                    auto expected = graph.FindRoute(request);
+                    for (const TransportGraphWrapper* wrapper : { &graph, &labeled, &loaded }) {
+                        auto time = wrapper->FindTravelTime(request, false);
+                        assert(time.rout_exists == expected->rout_exists);
+                        assert(std::abs(time.total_time - expected->total_time) < 1e-3);
+                        assert(wrapper == &graph || time.items.empty());
+
+                        auto route = wrapper->FindTravelTime(request, true);
+                        assert(std::abs(route.total_time - expected->total_time) < 1e-9);
+                        assert(route.items.size() == expected->items.size());
+                    }
+                }
+            }
+        }
+
+        void TestTimetableRouter() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            //1 km/min: line runs A10 B11 C13 B15 A16 and A30 B31 C33 B35 A36, ring runs A0 C5 A10 and A12 C17 A22
+            tc.SetBusDepartures("line", { 30, 10 });
+            tc.SetBusDepartures("ring", { 0, 12 });
+            TimetableRouter timetable(tc, 60);
+            assert(timetable.GetRouteCount() == 3);
+            assert(timetable.GetRunCount() == 6);
+
+            auto route = timetable.FindEarliestArrival(tc.FindStop("A"), tc.FindStop("C"), 9);
+            assert(route.rout_exists && std::abs(route.total_time - 4) < 1e-9);
+            assert(route.items.size() == 2);
+            assert(std::abs(std::get<WaitItem>(route.items[0]).time - 1) < 1e-9);
+            assert(std::get<BusItem>(route.items[1]).bus_name == "line" && std::get<BusItem>(route.items[1]).span_count == 2);
+
+            //the next line run is later than the ring
+            route = timetable.FindEarliestArrival(tc.FindStop("A"), tc.FindStop("C"), 11);
+            assert(std::abs(route.total_time - 6) < 1e-9);
+            assert(std::get<BusItem>(route.items[1]).bus_name == "ring");
+
+            //way back of the straight bus
+            route = timetable.FindEarliestArrival(tc.FindStop("B"), tc.FindStop("A"), 0);
+            assert(std::abs(route.total_time - 16) < 1e-9 && route.items.size() == 2);
+
+            //C17 by ring, A22 -> B31 by line, instead of waiting for the line at C33
+            route = timetable.FindEarliestArrival(tc.FindStop("C"), tc.FindStop("B"), 14);
+            assert(std::abs(route.total_time - 17) < 1e-9 && route.items.size() == 4);
+            assert(std::get<WaitItem>(route.items[2]).stop_name == "A");
+            assert(std::abs(std::get<WaitItem>(route.items[2]).time - 8) < 1e-9);
+            route = timetable.FindEarliestArrival(tc.FindStop("C"), tc.FindStop("B"), 14, 1);
+            assert(std::abs(route.total_time - 21) < 1e-9 && route.items.size() == 2);
+
+            assert(timetable.FindEarliestArrival(tc.FindStop("A"), tc.FindStop("A"), 5).rout_exists);
+            assert(!timetable.FindEarliestArrival(tc.FindStop("A"), tc.FindStop("D"), 0).rout_exists);
+            //no run after the last one
+            assert(!timetable.FindEarliestArrival(tc.FindStop("A"), tc.FindStop("C"), 40).rout_exists);
+        }
+
+        /// <summary>
+        /// size x size grid of stops, a straight bus along every row and every column
+        /// leaving every headway minutes from 6:00 to 22:00 (shifted from line to line).
+        /// With scramble_names the alphabetical order of the stops has nothing to do with the grid.
+        /// </summary>
+        void FillGridTimetable(TransportCatalogue& tc, size_t size, double headway, bool scramble_names = false) {
+            auto name = [size, scramble_names](size_t row, size_t column) {
+                const size_t id = row * size + column;
+                return (scramble_names ? std::to_string(id * 7919 % 1000003) : std::string()) + "s" + std::to_string(row) + "_" + std::to_string(column);
+            };
+            for (size_t row = 0; row < size; ++row) {
+                for (size_t column = 0; column < size; ++column) {
+                    tc.AddStop(name(row, column), { 55.6 + row * 0.004, 37.2 + column * 0.004 });
+                }
+            }
+            for (size_t row = 0; row < size; ++row) {
+                for (size_t column = 0; column < size; ++column) {
+                    const int distance = static_cast<int>(300 + 100 * ((row * 7 + column * 3) % 5));
+                    if (column + 1 < size) {
+                        tc.AddNearestStops(name(row, column), name(row, column + 1), distance);
+                    }
+                    if (row + 1 < size) {
+                        tc.AddNearestStops(name(row, column), name(row + 1, column), distance);
+                    }
+                }
+            }
+            for (size_t line = 0; line < 2 * size; ++line) {
+                std::vector<std::string> stops;
+                for (size_t k = 0; k < size; ++k) {
+                    stops.push_back(line < size ? name(line, k) : name(k, line - size));
+                }
+                const std::string bus = "bus" + std::to_string(line);
+                tc.AddBus(bus, stops, RouteKind::STRAIGHT);
+                std::vector<double> departures;
+                for (double time = 360 + (line * 3) % static_cast<size_t>(headway); time <= 1320; time += headway) {
+                    departures.push_back(time);
+                }
+                tc.SetBusDepartures(bus, departures);
+            }
+        }
+
+        void TestConnectionScan() {
+            TransportCatalogue tc;
+            FillSmallNetwork(tc);
+            tc.SetBusDepartures("line", { 30, 10 });
+            tc.SetBusDepartures("ring", { 0, 12 });
+            ConnectionScanRouter connections(tc, 60);
+            assert(connections.GetConnectionCount() == 12);
+
+            //C5 by ring, A10 -> B11 by line
+            auto profile = connections.FindProfile(tc.FindStop("C"), tc.FindStop("B"), 0, 40);
+            const std::vector<std::pair<double, double>> expected = { { 5, 11 }, { 13, 15 }, { 17, 31 }, { 33, 35 } };
+            assert(profile.size() == expected.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                assert(std::abs(profile[i].departure_time - expected[i].first) < 1e-9);
+                assert(std::abs(profile[i].arrival_time - expected[i].second) < 1e-9);
+            }
+            //only the trips leaving in the window: A10 by line, A12 by ring
+            profile = connections.FindProfile(tc.FindStop("A"), tc.FindStop("C"), 5, 20);
+            assert(profile.size() == 2);
+            assert(std::abs(profile[0].arrival_time - 13) < 1e-9 && std::abs(profile[1].arrival_time - 17) < 1e-9);
+            assert(connections.FindProfile(tc.FindStop("A"), tc.FindStop("D"), 0, 40).empty());
+
+            //same earliest arrivals as RAPTOR, on a grid with transfers
+            TransportCatalogue grid;
+            FillGridTimetable(grid, 6, 15);
+            ConnectionScanRouter scan(grid, 30);
+            TimetableRouter raptor(grid, 30);
+            const std::deque<Stop>& stops = grid.GetStops();
+            for (size_t from = 0; from < stops.size(); from += 5) {
+                for (size_t to = 0; to < stops.size(); ++to) {
+                    for (double departure : { 0.0, 487.0, 1315.0 }) {
+                        auto route = scan.FindEarliestArrival(&stops[from], &stops[to], departure);
+                        auto same = raptor.FindEarliestArrival(&stops[from], &stops[to], departure);
+                        assert(route.rout_exists == same.rout_exists);
+                        if (!route.rout_exists) {
+                            continue;
+                        }
+                        assert(std::abs(route.total_time - same.total_time) < 1e-9);
+                        double total = 0;
+                        for (const RouteItem& item : route.items) {
+                            total += std::holds_alternative<WaitItem>(item) ? std::get<WaitItem>(item).time : std::get<BusItem>(item).time;
+                        }
+                        assert(std::abs(total - route.total_time) < 1e-9);
+                        //the profile has the trip leaving first
+                        if (from != to && departure == 487.0) {
+                            auto first = scan.FindProfile(&stops[from], &stops[to], departure, departure + 60);
+                            assert(!first.empty() && std::abs(first.front().arrival_time - (departure + route.total_time)) < 1e-9);
+                        }
+                    }
+                }
+            }
+        }
+
+        void TestVertexOrder() {
+            TransportCatalogue tc;
+            FillGridTimetable(tc, 7, 15, true);
+            const std::deque<Stop>& stops = tc.GetStops();
+            for (GraphModel model : { GraphModel::STOP_PAIRS, GraphModel::RIDE_VERTICES }) {
+                RoutingSettings settings{ 30, 3, RouterMode::PER_QUERY };
+                settings.graph_model = model;
+                TransportGraphWrapper alphabetical(settings, tc);
+                alphabetical.BuildTransportGraph();
+                settings.vertex_order = VertexOrder::HILBERT;
+                TransportGraphWrapper hilbert(settings, tc);
+                hilbert.BuildTransportGraph();
+                settings.mode = RouterMode::ALL_PAIRS;
+                TransportGraphWrapper all_pairs(settings, tc);
+                all_pairs.BuildTransportGraph();
+
+                for (size_t from = 0; from < stops.size(); from += 3) {
+                    Stop* from_stop = tc.FindStop(stops[from].stop_name);
+                    for (size_t to = 0; to < stops.size(); ++to) {
+                        RouteRequest request{ from_stop, tc.FindStop(stops[to].stop_name) };
+                        auto expected = alphabetical.FindRoute(request);
+                        for (const TransportGraphWrapper* wrapper : { &hilbert, &all_pairs }) {
+                            auto route = wrapper->FindRoute(request);
+                            assert(route->rout_exists == expected->rout_exists);
+                            assert(std::abs(route->total_time - expected->total_time) < 1e-9);
+                        }
+                    }
+                    //stops are mapped back from their vertexes
+                    auto reachable = hilbert.FindReachableStops(from_stop, 20);
+                    auto same = alphabetical.FindReachableStops(from_stop, 20);
+                    assert(reachable.size() == same.size() && reachable.front().first == from_stop);
+                }
+            }
+        }
+
+        void TestRadixHeap() {
+            graph::RadixHeap<uint64_t, size_t> heap;
+            std::priority_queue<std::pair<uint64_t, size_t>, std::vector<std::pair<uint64_t, size_t>>,
+                std::greater<std::pair<uint64_t, size_t>>> expected;
+            unsigned seed = 5;
+            auto next = [&seed]() {
+                seed = seed * 1103515245u + 12345u;
+                return (seed >> 8) % 100000;
+            };
+            //as in Dijkstra: pushed keys are never smaller than the last popped one
+            uint64_t last = 0;
+            for (size_t i = 0; i < 5000; ++i) {
+                const size_t push_count = next() % 3;
+                for (size_t k = 0; k < push_count; ++k) {
+                    //duplicates and equal keys included
+                    const uint64_t key = last + next() % 2000;
+                    heap.push({ key, i });
+                    expected.push({ key, i });
+                }
+                if (!expected.empty() && next() % 2 == 0) {
+                    assert(heap.size() == expected.size());
+                    assert(heap.top().first == expected.top().first);
+                    last = heap.top().first;
+                    heap.pop();
+                    expected.pop();
+                }
+            }
+            while (!expected.empty()) {
+                assert(heap.top().first == expected.top().first);
+                heap.pop();
+                expected.pop();
+            }
+            assert(heap.empty());
+
+            bool thrown = false;
+            graph::RadixHeap<uint64_t, size_t> monotone;
+            monotone.push({ 10, 0 });
+            monotone.pop();
+            try {
+                monotone.push({ 9, 0 });
+            }
+            catch (const std::invalid_argument&) {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+
+        void BenchmarkAllPairs() {
+            //sparse, like a transport graph: a few edges per vertex
+            const size_t vertex_count = 1500;
+            const auto graph = MakeRandomGraph(vertex_count, vertex_count * 6, 3);
+            for (const auto algorithm : { graph::AllPairsAlgorithm::FLOYD_WARSHALL, graph::AllPairsAlgorithm::DIJKSTRA }) {
+                const auto start = std::chrono::steady_clock::now();
+                graph::Router<double> router(graph, algorithm);
+                const auto duration = std::chrono::steady_clock::now() - start;
+                std::cout << (algorithm == graph::AllPairsAlgorithm::DIJKSTRA ? "dijkstra: " : "floyd_warshall: ")
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+            }
+        }
+
+        void BenchmarkTimetable() {
+            TransportCatalogue tc;
+            FillGridTimetable(tc, 40, 10);
+            const std::deque<Stop>& stops = tc.GetStops();
+            TimetableRouter raptor(tc, 30);
+            ConnectionScanRouter scan(tc, 30);
+            TransportGraphWrapper graph(RoutingSettings{ 30, 5, RouterMode::PER_QUERY }, tc);
+            graph.BuildTransportGraph();
+
+            const size_t query_count = 300;
+            auto run = [&](const char* name, auto query) {
+                unsigned seed = 17;
+                const auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < query_count; ++i) {
+                    seed = seed * 1103515245u + 12345u;
+                    const Stop* from = &stops[(seed >> 8) % stops.size()];
+                    seed = seed * 1103515245u + 12345u;
+                    const Stop* to = &stops[(seed >> 8) % stops.size()];
+                    query(from, to, 420.0 + (seed >> 8) % 600);
+                }
+                const auto duration = std::chrono::steady_clock::now() - start;
+                std::cout << name << ": "
+                    << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / query_count << "us/query" << std::endl;
+            };
+            run("raptor", [&](const Stop* from, const Stop* to, double time) { raptor.FindEarliestArrival(from, to, time); });
+            run("connection_scan", [&](const Stop* from, const Stop* to, double time) { scan.FindEarliestArrival(from, to, time); });
+            run("connection_scan profile (1h)", [&](const Stop* from, const Stop* to, double time) { scan.FindProfile(from, to, time, time + 60); });
+            run("graph (no timetable)", [&](const Stop* from, const Stop* to, double) {
+                graph.FindRoute({ tc.FindStop(from->stop_name), tc.FindStop(to->stop_name) });
+            });
+        }
+
+        void BenchmarkVertexOrder() {
+            TransportCatalogue tc;
+            //RIDE_VERTICES: half a million vertexes, their arrays do not fit in the cache
+            FillGridTimetable(tc, 250, 10, true);
+            const std::deque<Stop>& stops = tc.GetStops();
+            for (VertexOrder order : { VertexOrder::ALPHABETICAL, VertexOrder::HILBERT }) {
+                RoutingSettings settings{ 30, 3, RouterMode::PER_QUERY };
+                settings.vertex_order = order;
+                settings.graph_model = GraphModel::RIDE_VERTICES;
+                //no route cache: every query is searched
+                TransportGraphWrapper graph(settings, tc, 0);
+                graph.BuildTransportGraph();
+
+                const size_t query_count = 100;
+                unsigned seed = 23;
+                const auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < query_count; ++i) {
+                    seed = seed * 1103515245u + 12345u;
+                    Stop* from = tc.FindStop(stops[(seed >> 8) % stops.size()].stop_name);
+                    seed = seed * 1103515245u + 12345u;
+                    Stop* to = tc.FindStop(stops[(seed >> 8) % stops.size()].stop_name);
+                    graph.FindRoute({ from, to });
+                }
+                const auto duration = std::chrono::steady_clock::now() - start;
+                std::cout << (order == VertexOrder::HILBERT ? "hilbert: " : "alphabetical: ")
+                    << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / query_count << "us/query" << std::endl;
+            }
+        }
+
+        void TestsRouting() {
+            TestLruCache();
+            TestRouteCache();
+            TestRoutesFromOrigin();
+            TestTravelTimeMatrix();
+            TestReachableStops();
+            TestRouteBetweenPoints();
+            TestRideVerticesModel();
+            TestRoutingOverride();
+            TestTiledRouter();
+            TestDijkstraAllPairs();
+            TestRadixHeap();
+            TestBidirectionalSearch();
+            TestHubLabels();
+            TestTravelTime();
+            TestTimetableRouter();
+            TestConnectionScan();
+            TestVertexOrder();
+            //BenchmarkAllPairs();
+            //BenchmarkTimetable();
+            //BenchmarkVertexOrder();
+            std::cout << "Unit Tests Routing: OK" << std::endl;
+        }
+
+    }
+
+}
@@ -2,7 +2,13 @@
 
 #include "transport_catalogue.h"
 #include "request_handler.h"
+#include "stop_index.h"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
 #include <vector>
 
 namespace catalogue {
@@ -50,22 +56,30 @@ namespace catalogue {
             tc.AddStop("B", { 33, 45 });
             tc.AddStop("C", { 52, 64 });
 
-            tc.AddBus( "bus1", {"A","B","C","B","A"} ,"C");
-            tc.AddBus( "bus2", {"A","B","A"} ,"A");
-            tc.AddBus( "bus3", {"C","B","C"} ,"C");
+            tc.AddBus( "bus1", {"A","B","C"} ,RouteKind::STRAIGHT);
+            tc.AddBus( "bus2", {"A","B","A"} ,RouteKind::ROUND_TRIP);
+            tc.AddBus( "bus3", {"C","B","C"} ,RouteKind::ROUND_TRIP);
 
             {
                 Bus* bus_ptr1 = tc.FindBus("bus1");
                 assert(bus_ptr1 != nullptr);
                 assert(bus_ptr1->bus_name == "bus1");
                 assert(bus_ptr1->CountUniqueStops() == 3);
-                std::vector<Stop*> stops = bus_ptr1->stops;
+                //stored one way, ridden there and back
+                assert(bus_ptr1->stops.size() == 3);
+                assert(bus_ptr1->GetEndStop()->stop_name == "C");
+                std::vector<Stop*> stops(bus_ptr1->GetFullRoute().begin(), bus_ptr1->GetFullRoute().end());
                 assert(stops.size() == 5);
                 assert(stops[0]->stop_name == "A");
                 assert(stops[1]->stop_name == "B");
                 assert(stops[2]->stop_name == "C");
                 assert(stops[3]->stop_name == "B");
                 assert(stops[4]->stop_name == "A");
+
+                Bus* bus_ptr2 = tc.FindBus("bus2");
+                assert(bus_ptr2->IsRoundTrip());
+                assert(bus_ptr2->GetEndStop()->stop_name == "A");
+                assert(bus_ptr2->GetFullRoute().size() == 3);
             }
 
             {
@@ -115,22 +129,22 @@ namespace catalogue {
         void TestParseBus() {
             {
                 std::string input = " aaw887:  Afaw   >  Opmn >   fawI  > bbZ   ";
-                std::pair<std::string, std::vector<std::string>> bus = ParseBusData(input);
-                assert(bus.first == "aaw887");
-                assert(bus.second.size() == 4);
-                assert(bus.second[1] == "Opmn");
+                BusInputData bus = ParseBusData(input);
+                assert(bus.name == "aaw887");
+                assert(bus.kind == RouteKind::ROUND_TRIP);
+                assert(bus.stops.size() == 4);
+                assert(bus.stops[1] == "Opmn");
             }
 
             {
                 std::string input = " Zua78:  ghP - Uzb - nha  ";
-                std::pair<std::string, std::vector<std::string>> bus = ParseBusData(input);
-                assert(bus.first == "Zua78");
-                assert(bus.second.size() == 5);
-                assert(bus.second[0] == "ghP");
-                assert(bus.second[1] == "Uzb");
-                assert(bus.second[2] == "nha");
-                assert(bus.second[3] == "Uzb");
-                assert(bus.second[4] == "ghP");
+                BusInputData bus = ParseBusData(input);
+                assert(bus.name == "Zua78");
+                assert(bus.kind == RouteKind::STRAIGHT);
+                assert(bus.stops.size() == 3);
+                assert(bus.stops[0] == "ghP");
+                assert(bus.stops[1] == "Uzb");
+                assert(bus.stops[2] == "nha");
             }
         }
 
@@ -142,9 +156,9 @@ namespace catalogue {
             tc.AddStop("C", { 52, 64 });
 
 
-            tc.AddBus( "bus1", {"A","B","C","B","A"} ,"C");
-            tc.AddBus( "bus2", {"A","B","A"} ,"A");
-            tc.AddBus( "bus3", {"C","B","C"} ,"C");
+            tc.AddBus( "bus1", {"A","B","C"} ,RouteKind::STRAIGHT);
+            tc.AddBus( "bus2", {"A","B","A"} ,RouteKind::ROUND_TRIP);
+            tc.AddBus( "bus3", {"C","B","C"} ,RouteKind::ROUND_TRIP);
 
             StopInputData data1{ "A",{0,0} ,{{"B",50}, {"C",100}} };
             StopInputData data2{ "B",{0,0} ,{ {"C",250} } };
@@ -195,9 +209,9 @@ namespace catalogue {
 
 
 
-            tc.AddBus( "ba125", {"Aa","Bb","Cc C","Bb","Aa"} ,"Cc c");
-            tc.AddBus( "ba023", {"Aa","Bb","Aa"} ,"Aa");
-            tc.AddBus( "bb963", {"Cc C","Bb","Cc C"} , "Cc C");
+            tc.AddBus( "ba125", {"Aa","Bb","Cc C"} ,RouteKind::STRAIGHT);
+            tc.AddBus( "ba023", {"Aa","Bb","Aa"} ,RouteKind::ROUND_TRIP);
+            tc.AddBus( "bb963", {"Cc C","Bb","Cc C"} , RouteKind::ROUND_TRIP);
             {
                 std::vector<OutputRequest> request = { { OutputType::STOP , { "Aa" } } };
                 std::ostringstream out;
@@ -268,9 +282,9 @@ namespace catalogue {
             tc.AddStop("B", { 1, 0 });
             tc.AddStop("C", { 2, 0 });
 
-            tc.AddBus( "bus1", {"A","B","C","B","A"} ,"C");
-            tc.AddBus( "bus2", {"A","B","A"} ,"A");
-            tc.AddBus( "bus3", {"C","B","C"} ,"C");
+            tc.AddBus( "bus1", {"A","B","C"} ,RouteKind::STRAIGHT);
+            tc.AddBus( "bus2", {"A","B","A"} ,RouteKind::ROUND_TRIP);
+            tc.AddBus( "bus3", {"C","B","C"} ,RouteKind::ROUND_TRIP);
 
             StopInputData stp1{ "A",{0,0} ,{{"B",50}, {"C",100}} };
             StopInputData stp2{ "B",{0,0} ,{ {"C",250} } };
@@ -297,7 +311,7 @@ namespace catalogue {
 
 
             tc.AddStop("Z", { 2, 0 });
-            tc.AddBus( "busZ", {"Z","Z"} ,"Z");
+            tc.AddBus( "busZ", {"Z","Z"} ,RouteKind::ROUND_TRIP);
             StopInputData stpZ{ "Z",{0,0} ,{ {"Z",123} } };
 
             for (auto stop_end : stpZ.connected_stop) {
@@ -309,6 +323,32 @@ namespace catalogue {
             assert(targetBusZ == resultBusZ);
         }
 
+        void TestSortedIndexes() {
+            TransportCatalogue tc;
+            tc.AddStop("D", { 11, 28 });
+            tc.AddStop("B", { 33, 45 });
+            tc.AddStop("lonely", { 52, 64 });
+            tc.AddStop("A", { 50, 60 });
+
+            tc.AddBus("z7", { "D","B" }, RouteKind::STRAIGHT);
+            assert(tc.GetStopsPtrInNetwork().size() == 2);
+            tc.AddBus("a1", { "B","A","B" }, RouteKind::ROUND_TRIP);
+            tc.AddBus("m3", { "D","A" }, RouteKind::STRAIGHT);
+
+            std::vector<std::string> bus_names;
+            for (const Bus* bus : tc.GetAllBuses()) {
+                bus_names.push_back(bus->bus_name);
+            }
+            assert((bus_names == std::vector<std::string>{ "a1", "m3", "z7" }));
+
+            //a stop without buses is not in the network
+            std::vector<std::string> stop_names;
+            for (const Stop* stop : tc.GetStopsPtrInNetwork()) {
+                stop_names.push_back(stop->stop_name);
+            }
+            assert((stop_names == std::vector<std::string>{ "A", "B", "D" }));
+        }
+
         void TestComputeCurvature() {
             TransportCatalogue tc;
 
@@ -320,9 +360,9 @@ namespace catalogue {
             tc.AddStop("B", { 14.2, 56.69 });
             tc.AddStop("C", { 23.89, 42.36 });
 
-            tc.AddBus( "bus1", {"A","B","C","B","A"} ,"C");
-            tc.AddBus( "bus2", {"A","B","A"} ,"A");
-            tc.AddBus( "bus3", {"C","B","C"} ,"C");
+            tc.AddBus( "bus1", {"A","B","C"} ,RouteKind::STRAIGHT);
+            tc.AddBus( "bus2", {"A","B","A"} ,RouteKind::ROUND_TRIP);
+            tc.AddBus( "bus3", {"C","B","C"} ,RouteKind::ROUND_TRIP);
 
             StopInputData stp1{ "A",{0,0} ,{{"B",5000}, {"C",10000}} };
             StopInputData stp2{ "B",{0,0} ,{ {"C",25000} } };
@@ -341,12 +381,144 @@ namespace catalogue {
             double dAB = ComputeDistance(cA, cB);
             double dBC = ComputeDistance(cB, cC);
             double curvatureTarget = targetTrafficDistance / (dAB * 2 + dBC * 2);
-            assert(curvatureTarget == resultCruvature);
+            assert(std::abs(curvatureTarget - resultCruvature) < 1e-12);
+
+
+        }
+
+        void TestComputeDistances() {
+            //pseudo-random points, some of them close or the same
+            unsigned seed = 29;
+            auto next = [&seed]() {
+                seed = seed * 1103515245u + 12345u;
+                return (seed >> 8) % 100000 / 100000.0;
+            };
+            std::vector<Coordinates> points;
+            TrigTerms terms;
+            for (int i = 0; i < 101; ++i) {
+                Coordinates point = i % 3 == 0 && i > 0 ? Coordinates{ points.back().lat + 0.001 * next(), points.back().lng }
+                    : Coordinates{ 180 * next() - 90, 360 * next() - 180 };
+                points.push_back(point);
+                terms.Add(point);
+            }
+            std::vector<uint32_t> from;
+            std::vector<uint32_t> to;
+            for (uint32_t i = 0; i < points.size(); ++i) {
+                from.push_back(i);
+                to.push_back(i == 50 ? i : (i * 7 + 1) % points.size());
+            }
+            std::vector<double> distances(from.size());
+            ComputeDistances(terms, from.data(), to.data(), from.size(), distances.data());
+            for (size_t i = 0; i < from.size(); ++i) {
+                const double expected = ComputeDistance(points[from[i]], points[to[i]]);
+                assert(std::abs(distances[i] - expected) < 0.05);
+                assert(std::abs(distances[i] - expected) <= 1e-9 * expected || expected < 1000);
+            }
+            assert(distances[50] == 0);
+        }
 
+        void TestComputeStopDistance() {
+            TransportCatalogue tc;
+            tc.AddStop("A", { 55.611087, 37.20829 });
+            tc.AddStop("B", { 55.595884, 37.209755 });
+            tc.AddStop("C", { -33.86, 151.21 });
+            const std::deque<Stop>& stops = tc.GetStops();
+            for (const Stop& from : stops) {
+                for (const Stop& to : stops) {
+                    const double expected = ComputeDistance(from.location, to.location);
+                    const double result = tc.ComputeStopDistance(from.id, to.id);
+                    assert(std::abs(result - expected) <= 1e-9 * expected);
+                }
+                assert(tc.ComputeStopDistance(from.id, from.id) == 0);
+            }
+        }
+
+        void BenchmarkStopDistances() {
+            TransportCatalogue tc;
+            unsigned seed = 31;
+            auto next = [&seed]() {
+                seed = seed * 1103515245u + 12345u;
+                return seed >> 8;
+            };
+            const size_t stop_count = 2000;
+            for (size_t i = 0; i < stop_count; ++i) {
+                tc.AddStop("S" + std::to_string(i), { 55.5 + 0.5 * (next() % 10000) / 10000.0, 37.3 + 0.6 * (next() % 10000) / 10000.0 });
+            }
+            const std::deque<Stop>& stops = tc.GetStops();
+            const size_t pair_count = 1000000;
+            std::vector<uint32_t> from;
+            std::vector<uint32_t> to;
+            for (size_t i = 0; i < pair_count; ++i) {
+                from.push_back(next() % stop_count);
+                to.push_back(next() % stop_count);
+            }
+            std::vector<double> distances(pair_count);
+
+            auto report = [pair_count](const char* name, std::chrono::steady_clock::duration duration, const std::vector<double>& values) {
+                double sum = 0;
+                for (double value : values) {
+                    sum += value;
+                }
+                std::cout << name << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / pair_count
+                    << "ns/pair (sum " << sum << ")" << std::endl;
+            };
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < pair_count; ++i) {
+                distances[i] = ComputeDistance(stops[from[i]].location, stops[to[i]].location);
+            }
+            report("coordinates: ", std::chrono::steady_clock::now() - start, distances);
+
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < pair_count; ++i) {
+                distances[i] = tc.ComputeStopDistance(from[i], to[i]);
+            }
+            report("cached trig: ", std::chrono::steady_clock::now() - start, distances);
 
+            start = std::chrono::steady_clock::now();
+            ComputeDistances(tc.GetStopColumns().trig, from.data(), to.data(), pair_count, distances.data());
+            report("batch: ", std::chrono::steady_clock::now() - start, distances);
         }
 
 
+        void TestStopIndex() {
+            TransportCatalogue tc;
+            //pseudo-random stops around Moscow
+            unsigned seed = 17;
+            auto next = [&seed]() {
+                seed = seed * 1103515245u + 12345u;
+                return (seed >> 8) % 10000 / 10000.0;
+            };
+            for (int i = 0; i < 300; ++i) {
+                tc.AddStop("S" + std::to_string(i), { 55.5 + 0.5 * next(), 37.3 + 0.6 * next() });
+            }
+
+            StopIndex index(tc.GetStopColumns());
+            StopIndex restored(tc.GetStopColumns(), index.GetOrder(), index.GetAxes());
+            const Coordinates point{ 55.75, 37.6 };
+
+            //brute force: all distances sorted
+            std::vector<double> expected;
+            for (const Stop& stop : tc.GetStops()) {
+                expected.push_back(ComputeDistance(point, stop.location));
+            }
+            std::sort(expected.begin(), expected.end());
+
+            for (const StopIndex* idx : { &index, &restored }) {
+                std::vector<StopDistance> nearest = idx->FindNearest(point, 5);
+                assert(nearest.size() == 5);
+                for (size_t i = 0; i < nearest.size(); ++i) {
+                    assert(std::abs(nearest[i].distance - expected[i]) < 1e-3);
+                }
+
+                const double radius = 5000;
+                size_t inside = std::count_if(expected.begin(), expected.end(), [radius](double d) { return d <= radius; });
+                assert(idx->FindWithin(point, radius).size() == inside);
+                assert(idx->FindNearest(point, 3, radius).size() == std::min<size_t>(3, inside));
+            }
+            assert(index.FindNearest(point, 0).empty());
+        }
+
         void AllUnitTests() {
             TestAddFindStop();
             TestAddFindBus();
@@ -355,7 +527,12 @@ namespace catalogue {
             TestRequestBusData();
             TestRequestStopData();
             TestComputeTrafficDistance();
+            TestSortedIndexes();
             TestComputeCurvature();
+            TestComputeDistances();
+            TestComputeStopDistance();
+            //BenchmarkStopDistances();
+            TestStopIndex();
             std::cout << "Unit Tests: OK" << std::endl;
         }
 
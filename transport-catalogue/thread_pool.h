@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+    /// <summary>
+    /// Number of threads to use when the caller does not specify it.
+    /// </summary>
+    inline size_t DefaultThreadCount() {
+        const size_t count = std::thread::hardware_concurrency();
+        return count == 0 ? 1 : count;
+    }
+
+    /// <summary>
+    /// Call body(thread_index, item) for every item in [0, item_count) on up to thread_count threads.
+    /// thread_index is in [0, thread_count): it lets the body keep per-thread scratch data.
+    /// Items are taken one by one, so uneven items are balanced. The first exception is rethrown.
+    /// </summary>
+    inline void ParallelFor(size_t item_count, size_t thread_count,
+        const std::function<void(size_t thread_index, size_t item)>& body) {
+        thread_count = std::max<size_t>(1, std::min(thread_count, item_count));
+        std::atomic<size_t> next_item = 0;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        auto work = [&](size_t thread_index) {
+            try {
+                for (size_t item = next_item++; item < item_count; item = next_item++) {
+                    body(thread_index, item);
+                }
+            }
+            catch (...) {
+                std::lock_guard lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next_item = item_count;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < thread_count; ++i) {
+            threads.emplace_back(work, i);
+        }
+        work(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /// <summary>
+    /// Fixed set of worker threads executing tasks in FIFO order.
+    /// The destructor finishes the queued tasks and joins the workers.
+    /// </summary>
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t thread_count = DefaultThreadCount()) {
+            for (size_t i = 0; i < thread_count; ++i) {
+                workers_.emplace_back([this]() { WorkerLoop(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(mutex_);
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            for (auto& worker : workers_) {
+                worker.join();
+            }
+        }
+
+        void Submit(std::function<void()> task) {
+            {
+                std::lock_guard lock(mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            cv_.notify_one();
+        }
+
+        size_t GetThreadCount() const {
+            return workers_.size();
+        }
+
+    private:
+        void WorkerLoop() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock(mutex_);
+                    cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+                    if (tasks_.empty()) {
+                        return;
+                    }
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopping_ = false;
+    };
+
+}  // namespace parallel
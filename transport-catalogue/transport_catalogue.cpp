@@ -2,13 +2,15 @@
 #include <algorithm>
 #include <set>
 #include <iomanip>
+#include <stdexcept>
 
 namespace catalogue {
 
 
 	void TransportCatalogue::AddStop(std::string stop_name, geo::Coordinates crd) {
-		Stop stop = { stop_name, crd };
+		Stop stop = { stop_name, crd, stops_.size() };
 		stops_.push_back(stop);
+		stop_columns_.Add(stop.stop_name, crd);
 		Stop* ptr_stop = &stops_.back();
 		stopname_to_stop.insert({ stop.stop_name,ptr_stop });
 		//Cross-data. First add empty set
@@ -17,20 +19,41 @@ namespace catalogue {
 
 
 
-	void TransportCatalogue::AddBus(std::string name_bus, const std::vector<std::string>& names_stops, std::string end_stop) {
+	void TransportCatalogue::AddBus(std::string name_bus, const std::vector<std::string>& names_stops, RouteKind kind) {
 		std::vector<Stop*> bus_stops;
 		for (const auto stop : names_stops) {
 			bus_stops.push_back(stopname_to_stop[stop]);
 		}
-		Stop* end_ptr = stopname_to_stop[end_stop];
-		buses_.push_back({ name_bus , bus_stops , end_ptr });
+		buses_.push_back({ name_bus , bus_stops , kind, {} });
 		Bus* ptr_bus = &buses_.back();
-		busname_to_bus.insert({ name_bus,  ptr_bus });
+		if (busname_to_bus.insert({ name_bus,  ptr_bus }).second) {
+			InsertSorted(sorted_buses_, ptr_bus, [](const Bus* bus) -> const std::string& { return bus->bus_name; });
+		}
 
 		//Cross-data.
 		for (Stop* stop_ptr : ptr_bus->stops) {
-			stopname_to_busnames[stop_ptr->stop_name].insert(ptr_bus->bus_name);
+			std::set<std::string>& busnames = stopname_to_busnames[stop_ptr->stop_name];
+			//the first bus through the stop brings it into the network
+			if (busnames.empty()) {
+				InsertSorted(stops_in_network_, stop_ptr, [](const Stop* stop) -> const std::string& { return stop->stop_name; });
+			}
+			busnames.insert(ptr_bus->bus_name);
+		}
+	}
+
+
+	void TransportCatalogue::SetBusDepartures(const std::string& name_bus, std::vector<double> departures) {
+		Bus* bus = FindBus(name_bus);
+		if (bus == nullptr) {
+			throw std::invalid_argument("Unknown bus: " + name_bus);
+		}
+		for (double departure : departures) {
+			if (!(departure >= 0)) {
+				throw std::invalid_argument("Departure times should be non-negative");
+			}
 		}
+		std::sort(departures.begin(), departures.end());
+		bus->departures = std::move(departures);
 	}
 
 
@@ -75,7 +98,7 @@ namespace catalogue {
 
 	std::vector<DirectDestination> TransportCatalogue::GetDirectDestinationsForRoundBus(const Bus* bus, const Stop* source, double velocity) const {
 		std::vector<DirectDestination> destinations;
-		std::vector<Stop*> line = bus->stops;
+		const std::vector<Stop*>& line = bus->stops;
 		auto final_it = line.end();
 		--final_it;
 		
@@ -101,20 +124,9 @@ namespace catalogue {
 	
 
 	std::vector<DirectDestination> TransportCatalogue::GetDirectDestinationsForStraightBus(const Bus* bus, const Stop* source, double velocity) const {
-		std::vector<Stop*> line = bus->stops;
-		Stop* starting_stop = bus->stops[0];
-		auto start_it = std::find(line.begin(), line.end(), starting_stop);
-		auto final_it = start_it + bus->stops.size();
-
-		size_t mid = (bus->stops.size() - 1) / 2;
-
-		//this the second terminal location
-		auto mid_it = start_it + mid;
-		auto past_mid_it =mid_it+1;
-		auto current = std::find(line.begin(), line.end(), source);
-
-		std::vector<DirectDestination> destinations = GetDirectDestinationsInRange(start_it, past_mid_it, *current,velocity);
-		std::vector<DirectDestination> destinations_backward = GetDirectDestinationsInRange(mid_it, final_it, *current, velocity);
+		//the way there, then the way back
+		std::vector<DirectDestination> destinations = GetDirectDestinationsInRange(bus->stops.begin(), bus->stops.end(), source, velocity);
+		std::vector<DirectDestination> destinations_backward = GetDirectDestinationsInRange(bus->stops.rbegin(), bus->stops.rend(), source, velocity);
 		for (auto elem : destinations_backward) {
 			destinations.push_back(elem);
 		}
@@ -132,6 +144,31 @@ namespace catalogue {
 	}
 
 
+	std::vector<std::vector<Stop*>> TransportCatalogue::GetTrips(const Bus* bus) const {
+		if (bus->IsRoundTrip()) {
+			return { bus->stops };
+		}
+		//same trips as GetDirectDestinationsForStraightBus
+		return {
+			bus->stops,
+			std::vector<Stop*>(bus->stops.rbegin(), bus->stops.rend())
+		};
+	}
+
+
+	std::vector<double> TransportCatalogue::GetTripTimes(const std::vector<Stop*>& trip, double velocity) const {
+		std::vector<double> times;
+		if (trip.empty()) {
+			return times;
+		}
+		times.push_back(0);
+		for (size_t i = 1; i < trip.size(); ++i) {
+			times.push_back(times.back() + ConvertToTime(GetDistanceBetweenStops(trip[i - 1], trip[i]), velocity));
+		}
+		return times;
+	}
+
+
 	void TransportCatalogue::AddNearestStops(std::string stop_start, std::string stop_end, int distance) {
 		Stop* stop_start_ptr = stopname_to_stop[stop_start];
 		Stop* stop_end_ptr = stopname_to_stop[stop_end];
@@ -141,16 +178,47 @@ namespace catalogue {
 
 	int TransportCatalogue::GetTrafficRoute(Bus* bus_ptr) const {
 		//Bus* bus_ptr = busname_to_bus.at(bus);
+		//the distances may differ on the way back
+		const RouteView route_stops = bus_ptr->GetFullRoute();
 		int route = 0;
-		for (size_t a = 0; a <= bus_ptr->stops.size() - 2; ++a) {
-			route += GetDistanceBetweenStops(bus_ptr->stops[a], bus_ptr->stops[a + 1]);
+		for (size_t a = 0; a + 1 < route_stops.size(); ++a) {
+			route += GetDistanceBetweenStops(route_stops[a], route_stops[a + 1]);
 		}
 		return route;
 	}
 
 	double TransportCatalogue::GetCurvatureBus(Bus* bus_ptr) const {
 		//Bus* bus_ptr = busname_to_bus.at(bus);
-		return GetTrafficRoute(bus_ptr) / (bus_ptr->GetRouteGeoLength());
+		return GetTrafficRoute(bus_ptr) / (GetRouteGeoLength(bus_ptr));
+	}
+
+	double TransportCatalogue::GetRouteGeoLength(const Bus* bus) const {
+		if (bus->stops.size() < 2) {
+			return 0.0;
+		}
+		//segment a: from the stop at a to the one at a + 1
+		std::vector<uint32_t> from;
+		std::vector<uint32_t> to;
+		for (size_t a = 0; a + 1 < bus->stops.size(); ++a) {
+			from.push_back(static_cast<uint32_t>(bus->stops[a]->id));
+			to.push_back(static_cast<uint32_t>(bus->stops[a + 1]->id));
+		}
+		std::vector<double> distances(from.size());
+		geo::ComputeDistances(stop_columns_.trig, from.data(), to.data(), from.size(), distances.data());
+		double route = 0.0;
+		for (double distance : distances) {
+			route += distance;
+		}
+		//the way back of a straight line is as long
+		return bus->IsRoundTrip() ? route : 2 * route;
+	}
+
+	double TransportCatalogue::ComputeStopDistance(size_t from, size_t to) const {
+		return geo::ComputeDistance(stop_columns_.trig, static_cast<uint32_t>(from), static_cast<uint32_t>(to));
+	}
+
+	const StopColumns& TransportCatalogue::GetStopColumns() const {
+		return stop_columns_;
 	}
 
 
@@ -209,12 +277,15 @@ namespace catalogue {
 	}
 	*/
 
-	const std::deque<Bus> TransportCatalogue::GetBuses() const {
+	const std::deque<Bus>& TransportCatalogue::GetBuses() const {
 		return buses_;
 	}
-	const std::deque<Stop> TransportCatalogue::GetStops() const {
+	const std::deque<Stop>& TransportCatalogue::GetStops() const {
 		return stops_;
 	}
+	Stop* TransportCatalogue::GetStop(size_t id) {
+		return &stops_.at(id);
+	}
 
 	/*
 	void SerializeTransportCatalogue(const TransportCatalogue& catalogue, std::ostream& output) {
@@ -312,33 +383,13 @@ namespace catalogue {
 	
 
 
-	std::vector<Bus*> TransportCatalogue::GetAllBuses() const {
-		std::vector<Bus*> buses;
-		std::set<std::string> bus_names;
-		for (auto elem : busname_to_bus) {
-			bus_names.insert(elem.first);
-		}
-		for (auto name : bus_names) {
-			buses.push_back(busname_to_bus.at(name));
-		}
-		return buses;
+	const std::vector<Bus*>& TransportCatalogue::GetAllBuses() const {
+		return sorted_buses_;
 	}
 
 
-	std::vector<Stop*> TransportCatalogue::GetStopsPtrInNetwork() const {
-		std::vector<Stop*> stops;
-		std::set<std::string> stop_names;
-
-		for (auto stp : stops_) {
-			if ((stopname_to_busnames.at(stp.stop_name)).size() > 0) {
-				stop_names.insert(stp.stop_name);
-			}
-
-		}
-		for (auto name : stop_names) {
-			stops.push_back(stopname_to_stop.at(name));
-		}
-		return stops;
+	const std::vector<Stop*>& TransportCatalogue::GetStopsPtrInNetwork() const {
+		return stops_in_network_;
 	}
 
 
@@ -350,7 +401,7 @@ namespace catalogue {
 		return BusInfo{
 			true,
 			bus_ptr->bus_name,
-			bus_ptr->stops.size(),
+			bus_ptr->GetFullRoute().size(),
 			bus_ptr->CountUniqueStops(),
 			GetTrafficRoute(bus_ptr),
 			GetCurvatureBus(bus_ptr)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -26,6 +27,8 @@ namespace catalogue {
 		Stop* destination_stop;
 		double travel_time;
 		int span_count;
+		//road distance in meters
+		double distance;
 	};
 
 
@@ -35,12 +38,19 @@ namespace catalogue {
 		void AddStop(std::string stop_name, geo::Coordinates crd);
 
 		/// <summary>
-		/// Add Bus to TC. The end_stop is relevant only for DRAWING, not for calculations.
+		/// Add Bus to TC. For a STRAIGHT line names_stops is the way there only:
+		/// the way back is not stored (Bus::GetFullRoute).
 		/// </summary>
 		/// <param name="name_bus"></param>
 		/// <param name="names_stops"></param>
-		/// <param name="end_stop"></param>
-		void AddBus(std::string name_bus, const std::vector<std::string>& names_stops, std::string end_stop);
+		/// <param name="kind"></param>
+		void AddBus(std::string name_bus, const std::vector<std::string>& names_stops, RouteKind kind);
+
+		/// <summary>
+		/// Departure times (minutes since midnight) of the bus from its first stop. A straight bus
+		/// rides back as soon as it reaches the terminal.
+		/// </summary>
+		void SetBusDepartures(const std::string& name_bus, std::vector<double> departures);
 
 		void AddNearestStops(std::string stop_start, std::string stop_end, int distance);
 
@@ -52,10 +62,10 @@ namespace catalogue {
 		int GetDistanceBetweenStops(Stop* start, Stop* end) const;
 
 		/// <summary>
-		/// Return all Buses in alphabetical order.
+		/// Return all Buses in alphabetical order. Kept sorted by AddBus: nothing is built here.
 		/// </summary>
 		/// <returns></returns>
-		std::vector<Bus*> GetAllBuses() const;
+		const std::vector<Bus*>& GetAllBuses() const;
 
 
 		/// <summary>
@@ -64,9 +74,10 @@ namespace catalogue {
 		//std::vector<geo::Coordinates> GetStopsInNetwork() const;
 
 		/// <summary>
-		/// Return the Ptr on Stops in the Network, in ALPHABETICAL order
+		/// Return the Ptr on Stops in the Network (on a bus line), in ALPHABETICAL order.
+		/// Kept sorted by AddBus: nothing is built here.
 		/// </summary>
-		std::vector<Stop*> GetStopsPtrInNetwork() const;
+		const std::vector<Stop*>& GetStopsPtrInNetwork() const;
 
 
 		/// <summary>
@@ -75,8 +86,46 @@ namespace catalogue {
 		std::vector<DirectDestination> GetDirectDestinations(const Bus* bus, const Stop* source, double bus_speed) const;
 
 
-		const std::deque<Bus> GetBuses() const;
-		const std::deque<Stop> GetStops() const;
+		/// <summary>
+		/// Stops of every trip of the bus in riding order: the whole line for a round bus,
+		/// there and back (split at the terminal) for a straight bus. A trip is never ridden
+		/// through its last stop, as in GetDirectDestinations.
+		/// </summary>
+		std::vector<std::vector<Stop*>> GetTrips(const Bus* bus) const;
+
+		/// <summary>
+		/// Ride time (minutes) from the first stop of a trip to each of its stops at the given velocity (km/h).
+		/// </summary>
+		std::vector<double> GetTripTimes(const std::vector<Stop*>& trip, double velocity) const;
+
+		/// <summary>
+		/// Time (minutes) to ride the distance (meters) at the given velocity (km/h).
+		/// </summary>
+		static double ConvertToTime(double distance, double velocity);
+
+
+		const std::deque<Bus>& GetBuses() const;
+		const std::deque<Stop>& GetStops() const;
+
+		/// <summary>
+		/// Stop by Stop::id (its position in GetStops()), without a lookup by name.
+		/// </summary>
+		Stop* GetStop(size_t id);
+
+		/// <summary>
+		/// Coordinates and names of all the stops as columns, by Stop::id.
+		/// </summary>
+		const StopColumns& GetStopColumns() const;
+
+		/// <summary>
+		/// Geographic length (meters) of the bus line, from the stop columns.
+		/// </summary>
+		double GetRouteGeoLength(const Bus* bus) const;
+
+		/// <summary>
+		/// Great-circle distance (meters) between the stops by Stop::id, from their cached sin/cos.
+		/// </summary>
+		double ComputeStopDistance(size_t from, size_t to) const;
 
 		/// <summary>
 		/// Give the stops that are directly reachable from start stop.
@@ -102,21 +151,31 @@ namespace catalogue {
 		std::vector<DirectDestination> GetDirectDestinationsInRange(const StopIt start, const StopIt finish, const Stop* source, double velocity) const;
 
 
-		static double ConvertToTime(double distance, double velocity);
-
 		int GetTrafficRoute(Bus* bus) const;
 		double GetCurvatureBus(Bus* bus) const;
 
+		/// <summary>
+		/// Insert into a vector sorted by name, keeping it sorted.
+		/// </summary>
+		template <typename T, typename GetName>
+		static void InsertSorted(std::vector<T*>& sorted, T* item, GetName get_name);
+
 
 
 		std::deque<Stop> stops_;
 
+		StopColumns stop_columns_;
+
 		std::unordered_map<std::string, Stop*> stopname_to_stop;
 
 		std::deque<Bus> buses_;
 
 		std::unordered_map<std::string, Bus*> busname_to_bus;
 
+		//indexes by name, see GetAllBuses and GetStopsPtrInNetwork
+		std::vector<Bus*> sorted_buses_;
+		std::vector<Stop*> stops_in_network_;
+
 		std::unordered_map < std::string, std::set < std::string >> stopname_to_busnames;
 
 		std::unordered_map<std::pair<Stop*, Stop*>, int, PairOfStopsPtrHasher> stops_to_distances;
@@ -130,13 +189,15 @@ namespace catalogue {
 		std::vector<DirectDestination> destinations;
 		double travel_time = 0;
 		int span_count = 0;
+		double total_distance = 0;
 		StopIt current = source;
 		StopIt next = source;
 		while (++next <= destination) {
 			double distance = GetDistanceBetweenStops(*current, *next);
 			travel_time += ConvertToTime(distance, velocity);
+			total_distance += distance;
 			++span_count;
-			DirectDestination destination{ *next , travel_time , span_count };
+			DirectDestination destination{ *next , travel_time , span_count, total_distance };
 			destinations.push_back(destination);
 			++current;
 		}
@@ -149,13 +210,15 @@ namespace catalogue {
 		std::vector<DirectDestination> destinations;
 		double travel_time = 0;
 		int span_count = 0;
+		double total_distance = 0;
 		StopIt current = source;
 		StopIt previous = source;
 		while (current != destination && --previous >= destination) {
 			double distance = GetDistanceBetweenStops(*previous, *current);
 			travel_time += ConvertToTime(distance, velocity);
+			total_distance += distance;
 			++span_count;
-			DirectDestination destination{ *previous , travel_time , span_count };
+			DirectDestination destination{ *previous , travel_time , span_count, total_distance };
 			destinations.push_back(destination);
 			--current;
 
@@ -163,6 +226,14 @@ namespace catalogue {
 		return destinations;
 	}
 
+	template <typename T, typename GetName>
+	void TransportCatalogue::InsertSorted(std::vector<T*>& sorted, T* item, GetName get_name) {
+		auto position = std::lower_bound(sorted.begin(), sorted.end(), item, [&get_name](const T* lhs, const T* rhs) {
+			return get_name(lhs) < get_name(rhs);
+		});
+		sorted.insert(position, item);
+	}
+
 	template <typename StopIt>
 	std::vector<DirectDestination> TransportCatalogue::GetDirectDestinationsInRange(const StopIt start, const StopIt end, const Stop* source, double velocity) const {
 		std::vector<DirectDestination> destinations;
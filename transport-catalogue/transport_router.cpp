@@ -1,12 +1,50 @@
 #include "transport_router.h"
 
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+
+
+namespace {
+
+	//side of the grid of the Hilbert curve
+	const uint32_t HILBERT_SIDE = 1u << 16;
+
+	/// <summary>
+	/// Position of the cell (x, y) along the Hilbert curve over the HILBERT_SIDE x HILBERT_SIDE grid.
+	/// </summary>
+	uint64_t HilbertIndex(uint32_t x, uint32_t y) {
+		uint64_t index = 0;
+		for (uint32_t side = HILBERT_SIDE / 2; side > 0; side /= 2) {
+			const uint32_t rx = (x & side) > 0 ? 1 : 0;
+			const uint32_t ry = (y & side) > 0 ? 1 : 0;
+			index += static_cast<uint64_t>(side) * side * ((3 * rx) ^ ry);
+			//rotate the quadrant so that the curve is continuous
+			if (ry == 0) {
+				if (rx == 1) {
+					x = HILBERT_SIDE - 1 - x;
+					y = HILBERT_SIDE - 1 - y;
+				}
+				std::swap(x, y);
+			}
+		}
+		return index;
+	}
+
+}
 
 
 
 
-TransportGraphWrapper::TransportGraphWrapper(RoutingSettings settings, catalogue::TransportCatalogue& tc)
+
+TransportGraphWrapper::TransportGraphWrapper(RoutingSettings settings, catalogue::TransportCatalogue& tc, size_t route_cache_capacity)
 	: catalogue_(tc)
-	, settings_(settings) {
+	, settings_(settings)
+	, route_cache_(route_cache_capacity) {
 
 }
 
@@ -15,44 +53,361 @@ TransportGraphWrapper::TransportGraphWrapper(RoutingSettings settings, catalogue
 void TransportGraphWrapper::BuildTransportGraph() {
 	InitializeGraph();
 	AddWaitingEdges();
-	AddBusEdges();
+	if (settings_.graph_model == GraphModel::RIDE_VERTICES) {
+		AddRideEdges();
+	}
+	else {
+		AddBusEdges();
+	}
+	if (settings_.vertex_order == VertexOrder::HILBERT) {
+		SortEdgesBySource();
+	}
 	InitializeRouter();
 }
 
 
 
 
-TransportRouteInfo TransportGraphWrapper::FindRoute(RouteRequest request) const {
+std::shared_ptr<const TransportRouteInfo> TransportGraphWrapper::FindRoute(RouteRequest request) const {
+	return FindRoutesFromOrigin(request.fromStop, { request.toStop }).front();
+}
+
+
+TransportRouteInfo TransportGraphWrapper::FindRoute(RouteRequest request, const RoutingOverride& routing_override) const {
+	RoutingSettings metric = settings_;
+	metric.velocity = routing_override.velocity.value_or(settings_.velocity);
+	metric.wait_time = routing_override.wait_time.value_or(settings_.wait_time);
+	if (metric.velocity <= 0 || metric.wait_time < 0) {
+		throw std::invalid_argument("Velocity should be positive and wait time non-negative");
+	}
+	if (metric.velocity == settings_.velocity && metric.wait_time == settings_.wait_time) {
+		return *FindRoute(request);
+	}
+	if (stop_to_vertexid.count(request.fromStop) == 0 || stop_to_vertexid.count(request.toStop) == 0) {
+		return PostProcessFindRoute(std::nullopt);
+	}
+	graph::VertexId fromVertex = stop_to_vertexid.at(request.fromStop) - 1;
+	graph::VertexId toVertex = stop_to_vertexid.at(request.toStop) - 1;
+
+	graph::BidirectionalSearch<GraphTime> search(network_graph_, [this, &metric](graph::EdgeId edge_id) {
+		return ToGraphTime(GetEdgeTime(edgeid_to_data[edge_id], metric));
+	});
+	return PostProcessFindRoute(search.FindRoute(fromVertex, toVertex), &metric);
+}
+
+
+std::vector<std::shared_ptr<const TransportRouteInfo>> TransportGraphWrapper::FindRoutesFromOrigin(
+	catalogue::Stop* from_stop,
+	const std::vector<catalogue::Stop*>& to_stops) const {
+
+	std::vector<std::shared_ptr<const TransportRouteInfo>> routes(to_stops.size());
+	const auto not_found = std::make_shared<const TransportRouteInfo>(PostProcessFindRoute(std::nullopt));
+	if (stop_to_vertexid.count(from_stop) == 0) {
+		std::fill(routes.begin(), routes.end(), not_found);
+		return routes;
+	}
+	graph::VertexId fromVertex = stop_to_vertexid.at(from_stop) - 1;
+
+	//targets that are neither unknown nor cached
+	std::vector<size_t> searched;
+	std::vector<graph::VertexId> targets;
+	for (size_t i = 0; i < to_stops.size(); ++i) {
+		if (stop_to_vertexid.count(to_stops[i]) == 0) {
+			routes[i] = not_found;
+			continue;
+		}
+		graph::VertexId toVertex = stop_to_vertexid.at(to_stops[i]) - 1;
+		if (auto cached = route_cache_.Get({ fromVertex, toVertex })) {
+			routes[i] = *cached;
+			continue;
+		}
+		searched.push_back(i);
+		targets.push_back(toVertex);
+	}
+	if (targets.empty()) {
+		return routes;
+	}
+
+	if (settings_.mode == RouterMode::ALL_PAIRS) {
+		for (size_t k = 0; k < searched.size(); ++k) {
+			routes[searched[k]] = std::make_shared<const TransportRouteInfo>(PostProcessFindRoute(router_ptr_->BuildRoute(fromVertex, targets[k])));
+		}
+	}
+	else if (targets.size() == 1) {
+		//a single route: search from both ends
+		graph::BidirectionalSearch<GraphTime> search(network_graph_);
+		routes[searched.front()] = std::make_shared<const TransportRouteInfo>(PostProcessFindRoute(search.FindRoute(fromVertex, targets.front())));
+	}
+	else {
+		//one search for all the targets of this origin
+		graph::ShortestPathSearch<GraphTime> search(network_graph_);
+		search.AddSource(fromVertex);
+		search.RunUntilSettled(targets);
+		for (size_t k = 0; k < searched.size(); ++k) {
+			routes[searched[k]] = std::make_shared<const TransportRouteInfo>(PostProcessFindRoute(search.BuildRoute(targets[k])));
+		}
+	}
+
+	for (size_t k = 0; k < searched.size(); ++k) {
+		route_cache_.Put({ fromVertex, targets[k] }, routes[searched[k]]);
+	}
+	return routes;
+}
+
+
+std::vector<std::vector<std::optional<double>>> TransportGraphWrapper::ComputeTravelTimes(
+	const std::vector<catalogue::Stop*>& from_stops,
+	const std::vector<catalogue::Stop*>& to_stops,
+	size_t thread_count) const {
+
+	std::vector<std::vector<std::optional<double>>> times(from_stops.size(), std::vector<std::optional<double>>(to_stops.size()));
+
+	//buckets: target vertex => columns of the matrix it answers
+	std::unordered_map<graph::VertexId, std::vector<size_t>> buckets;
+	for (size_t j = 0; j < to_stops.size(); ++j) {
+		auto it = stop_to_vertexid.find(to_stops[j]);
+		if (it != stop_to_vertexid.end()) {
+			buckets[it->second - 1].push_back(j);
+		}
+	}
+	if (buckets.empty()) {
+		return times;
+	}
+
+	//one search object per thread, allocated on first use
+	std::vector<std::unique_ptr<graph::ShortestPathSearch<GraphTime>>> searches(std::max<size_t>(1, thread_count));
+	parallel::ParallelFor(from_stops.size(), searches.size(), [&](size_t thread_index, size_t i) {
+		auto it = stop_to_vertexid.find(from_stops[i]);
+		if (it == stop_to_vertexid.end()) {
+			return;
+		}
+		auto& search = searches[thread_index];
+		if (!search) {
+			search = std::make_unique<graph::ShortestPathSearch<GraphTime>>(network_graph_);
+		}
+		search->Reset();
+		search->AddSource(it->second - 1);
+
+		size_t remaining = buckets.size();
+		while (remaining > 0) {
+			const std::optional<graph::VertexId> settled = search->SettleNext();
+			if (!settled) {
+				break;
+			}
+			auto bucket = buckets.find(*settled);
+			if (bucket == buckets.end()) {
+				continue;
+			}
+			const double time = ToMinutes(*search->GetDistance(*settled));
+			for (size_t j : bucket->second) {
+				times[i][j] = time;
+			}
+			--remaining;
+		}
+	});
+	return times;
+}
+
+
+std::vector<std::pair<catalogue::Stop*, double>> TransportGraphWrapper::FindReachableStops(catalogue::Stop* from_stop, double time_budget) const {
+	std::vector<std::pair<catalogue::Stop*, double>> reachable;
+	auto it = stop_to_vertexid.find(from_stop);
+	if (it == stop_to_vertexid.end() || time_budget < 0) {
+		return reachable;
+	}
+
+	graph::ShortestPathSearch<GraphTime> search(network_graph_);
+	search.AddSource(it->second - 1);
+	for (graph::VertexId vertex : search.RunWithin(ToGraphTime(time_budget))) {
+		//arrival at a stop = arrival at its waiting vertex, as for Route
+		const VertexData& data = vertexid_to_data.at(vertex);
+		if (data.type == VertexType::WAITINGVERTEX) {
+			reachable.emplace_back(data.stop, ToMinutes(*search.GetDistance(vertex)));
+		}
+	}
+	return reachable;
+}
+
+
+TransportRouteInfo TransportGraphWrapper::FindRouteBetweenPoints(
+	const std::vector<StopAccess>& origins,
+	const std::vector<StopAccess>& destinations,
+	double direct_walk) const {
+
+	//best arrival in graph time, walks included
+	GraphTime best_time = std::numeric_limits<GraphTime>::max();
+	if (direct_walk <= settings_.walk_radius) {
+		best_time = ToGraphTime(GetWalkTime(direct_walk));
+	}
+
+	//walk time from the waiting vertex of every reachable destination stop
+	std::unordered_map<graph::VertexId, const StopAccess*> targets;
+	for (const StopAccess& access : destinations) {
+		auto it = stop_to_vertexid.find(access.stop);
+		if (it != stop_to_vertexid.end()) {
+			targets[it->second - 1] = &access;
+		}
+	}
+
+	graph::ShortestPathSearch<GraphTime> search(network_graph_);
+	std::unordered_map<graph::VertexId, const StopAccess*> sources;
+	for (const StopAccess& access : origins) {
+		auto it = stop_to_vertexid.find(access.stop);
+		if (it != stop_to_vertexid.end() && !targets.empty()) {
+			search.AddSource(it->second - 1, ToGraphTime(GetWalkTime(access.distance)));
+			sources[it->second - 1] = &access;
+		}
+	}
+
+	std::optional<graph::VertexId> best_target;
+	while (const std::optional<graph::VertexId> settled = search.SettleNext()) {
+		const GraphTime time = *search.GetDistance(*settled);
+		if (time >= best_time) {
+			//vertexes are settled in increasing time: nothing can improve the best arrival
+			break;
+		}
+		auto target = targets.find(*settled);
+		if (target != targets.end() && time + ToGraphTime(GetWalkTime(target->second->distance)) < best_time) {
+			best_time = time + ToGraphTime(GetWalkTime(target->second->distance));
+			best_target = *settled;
+		}
+	}
+
+	if (!best_target) {
+		if (best_time == std::numeric_limits<GraphTime>::max()) {
+			return PostProcessFindRoute(std::nullopt);
+		}
+		return { true, GetWalkTime(direct_walk), { WalkItem{ "", "", GetWalkTime(direct_walk), direct_walk } } };
+	}
+
+	std::optional<graph::Router<GraphTime>::RouteInfo> ride = search.BuildRoute(*best_target);
+	const graph::VertexId source = ride->edges.empty() ? *best_target : network_graph_.GetEdge(ride->edges.front()).from;
+	const StopAccess& from = *sources.at(source);
+	const StopAccess& to = *targets.at(*best_target);
+
+	TransportRouteInfo route = PostProcessFindRoute(ride);
+	route.items.insert(route.items.begin(), WalkItem{ "", from.stop->stop_name, GetWalkTime(from.distance), from.distance });
+	route.items.push_back(WalkItem{ to.stop->stop_name, "", GetWalkTime(to.distance), to.distance });
+	route.total_time += GetWalkTime(from.distance) + GetWalkTime(to.distance);
+	return route;
+}
+
+
+GraphTime TransportGraphWrapper::ToGraphTime(double minutes) {
+	return static_cast<GraphTime>(std::llround(minutes * GRAPH_TIME_PER_MINUTE));
+}
+
+
+double TransportGraphWrapper::ToMinutes(GraphTime time) {
+	return time / GRAPH_TIME_PER_MINUTE;
+}
+
+
+double TransportGraphWrapper::GetWalkTime(double distance) const {
+	//same conversion as for buses
+	return distance / settings_.walk_velocity * 60 / 1000;
+}
+
+
+TransportRouteInfo TransportGraphWrapper::FindTravelTime(RouteRequest request, bool with_items) const {
+	if (!hub_labels_) {
+		return *FindRoute(request);
+	}
 	if (stop_to_vertexid.count(request.fromStop) == 0 || stop_to_vertexid.count(request.toStop) == 0) {
 		return PostProcessFindRoute(std::nullopt);
 	}
 	graph::VertexId fromVertex = stop_to_vertexid.at(request.fromStop) - 1;
 	graph::VertexId toVertex = stop_to_vertexid.at(request.toStop) - 1;
-	return PostProcessFindRoute(router_ptr_->BuildRoute(fromVertex, toVertex));
+	if (with_items) {
+		return PostProcessFindRoute(hub_labels_->BuildRoute(fromVertex, toVertex));
+	}
+	const std::optional<GraphTime> time = hub_labels_->GetDistance(fromVertex, toVertex);
+	if (!time) {
+		return PostProcessFindRoute(std::nullopt);
+	}
+	return { true, ToMinutes(*time), {} };
+}
+
+
+void TransportGraphWrapper::BuildHubLabels() {
+	hub_labels_ = std::make_unique<graph::HubLabels<GraphTime>>(network_graph_);
+}
+
+
+void TransportGraphWrapper::LoadHubLabels(graph::HubLabelStorage<GraphTime> storage) {
+	hub_labels_ = std::make_unique<graph::HubLabels<GraphTime>>(network_graph_, std::move(storage));
+}
+
 
+const graph::HubLabels<GraphTime>* TransportGraphWrapper::GetHubLabels() const {
+	return hub_labels_.get();
+}
+
+
+cache::CacheStats TransportGraphWrapper::GetRouteCacheStats() const {
+	return route_cache_.GetStats();
 }
 
 
 void TransportGraphWrapper::InitializeGraph() {
-	std::vector<catalogue::Stop*> stops = catalogue_.GetStopsPtrInNetwork();
-	size_t stop_nmb = stops.size();
+	size_t stop_nmb = catalogue_.GetStopsPtrInNetwork().size();
 	size_t vertex_nmb = 2 * stop_nmb;
-	network_graph_ = graph::DirectedWeightedGraph<double>(vertex_nmb);;
+	if (settings_.graph_model == GraphModel::RIDE_VERTICES) {
+		//ride vertexes are numbered after the stops' ones
+		for (auto bus_ptr : catalogue_.GetAllBuses()) {
+			for (const auto& trip : catalogue_.GetTrips(bus_ptr)) {
+				vertex_nmb += trip.size();
+			}
+		}
+	}
+	network_graph_ = graph::DirectedWeightedGraph<GraphTime>(vertex_nmb);;
+	vertexid_to_data.assign(vertex_nmb, { VertexType::WAITINGVERTEX, nullptr });
 }
 
 
-void TransportGraphWrapper::AddWaitingEdges() {
+std::vector<catalogue::Stop*> TransportGraphWrapper::GetStopsInVertexOrder() const {
 	std::vector<catalogue::Stop*> stops = catalogue_.GetStopsPtrInNetwork();
+	if (settings_.vertex_order == VertexOrder::ALPHABETICAL || stops.empty()) {
+		return stops;
+	}
+	//cells of a 2^16 x 2^16 grid over the bounding box of the stops
+	double min_lat = stops.front()->location.lat;
+	double max_lat = min_lat;
+	double min_lng = stops.front()->location.lng;
+	double max_lng = min_lng;
+	for (const catalogue::Stop* stop : stops) {
+		min_lat = std::min(min_lat, stop->location.lat);
+		max_lat = std::max(max_lat, stop->location.lat);
+		min_lng = std::min(min_lng, stop->location.lng);
+		max_lng = std::max(max_lng, stop->location.lng);
+	}
+	auto to_cell = [](double value, double min, double max) {
+		return max > min ? static_cast<uint32_t>(std::lround((value - min) / (max - min) * (HILBERT_SIDE - 1))) : 0u;
+	};
+	std::unordered_map<const catalogue::Stop*, uint64_t> keys;
+	for (const catalogue::Stop* stop : stops) {
+		keys[stop] = HilbertIndex(to_cell(stop->location.lng, min_lng, max_lng), to_cell(stop->location.lat, min_lat, max_lat));
+	}
+	//stable: stops in the same cell stay in alphabetical order
+	std::stable_sort(stops.begin(), stops.end(), [&keys](const catalogue::Stop* lhs, const catalogue::Stop* rhs) {
+		return keys.at(lhs) < keys.at(rhs);
+	});
+	return stops;
+}
+
+
+void TransportGraphWrapper::AddWaitingEdges() {
+	std::vector<catalogue::Stop*> stops = GetStopsInVertexOrder();
 	size_t stop_nmb = stops.size();
 	size_t vertex_nmb = 2 * stop_nmb;
 	size_t stop_index = 0;
 	size_t vertex_index = 0;
 	while (stop_index < stop_nmb && vertex_index < vertex_nmb) {
 
-		double time = settings_.wait_time;
-		graph::EdgeId id = network_graph_.AddEdge({ vertex_index, vertex_index + 1 , time });
-
-		edgeid_to_data[id] = { EdgeType::WAIT, nullptr,stops[stop_index]  ,time, 0 };
+		//RIDE_VERTICES model: the wait is on the boarding edges
+		if (settings_.graph_model == GraphModel::STOP_PAIRS) {
+			AddEdge(vertex_index, vertex_index + 1, { EdgeType::WAIT, nullptr,stops[stop_index] ,settings_.wait_time, 0, 0 });
+		}
 		vertexid_to_data[vertex_index] = { VertexType::WAITINGVERTEX, stops[stop_index] };
 		vertexid_to_data[vertex_index + 1] = { VertexType::REALSTOP, stops[stop_index] };
 		stop_to_vertexid[stops[stop_index]] = vertex_index + 1;
@@ -63,9 +418,13 @@ void TransportGraphWrapper::AddWaitingEdges() {
 
 void TransportGraphWrapper::AddBusEdges() {
 	for (auto bus_ptr : catalogue_.GetAllBuses()) {
-		//unique stops on this bus-line
-		std::set<catalogue::Stop*> stops_on_line((bus_ptr->stops).begin(), (bus_ptr->stops).end());
-		for (catalogue::Stop* source_stop : stops_on_line) {
+		//unique stops on this bus-line, in the order of the line: edge ids do not depend on
+		//the addresses of the stops, so data stored with the base (hub labels) stays valid
+		std::set<catalogue::Stop*> seen;
+		for (catalogue::Stop* source_stop : bus_ptr->stops) {
+			if (!seen.insert(source_stop).second) {
+				continue;
+			}
 
 			std::vector<catalogue::DirectDestination> destinations = catalogue_.GetDirectDestinations(bus_ptr, source_stop, settings_.velocity);
 
@@ -73,30 +432,73 @@ void TransportGraphWrapper::AddBusEdges() {
 				graph::VertexId source_id = stop_to_vertexid[source_stop];
 				graph::VertexId destination_id = stop_to_vertexid[destination.destination_stop] - 1;
 
-				graph::EdgeId id = network_graph_.AddEdge({ source_id, destination_id , destination.travel_time });
-				edgeid_to_data[id] = { EdgeType::BUS, bus_ptr, nullptr , destination.travel_time, destination.span_count };
+				AddEdge(source_id, destination_id, { EdgeType::BUS, bus_ptr, nullptr , destination.travel_time, destination.span_count, destination.distance });
+			}
+		}
+	}
+}
+
+void TransportGraphWrapper::AddRideEdges() {
+	graph::VertexId ride_id = 2 * stop_to_vertexid.size();
+	for (auto bus_ptr : catalogue_.GetAllBuses()) {
+		for (const auto& trip : catalogue_.GetTrips(bus_ptr)) {
+			for (size_t i = 0; i < trip.size(); ++i, ++ride_id) {
+				catalogue::Stop* stop = trip[i];
+				graph::VertexId waiting_id = stop_to_vertexid.at(stop) - 1;
+				vertexid_to_data[ride_id] = { VertexType::RIDE, stop };
+
+				//no boarding at the last stop of a trip, no alighting at the first one
+				if (i + 1 < trip.size()) {
+					AddEdge(waiting_id, ride_id, { EdgeType::BOARD, bus_ptr, stop, settings_.wait_time, 0, 0 });
+
+					double distance = catalogue_.GetDistanceBetweenStops(stop, trip[i + 1]);
+					double time = catalogue::TransportCatalogue::ConvertToTime(distance, settings_.velocity);
+					AddEdge(ride_id, ride_id + 1, { EdgeType::RIDE, bus_ptr, nullptr, time, 1, distance });
+				}
+				if (i > 0) {
+					AddEdge(ride_id, waiting_id, { EdgeType::ALIGHT, bus_ptr, nullptr, 0, 0, 0 });
+				}
 			}
 		}
 	}
 }
 
 void TransportGraphWrapper::InitializeRouter() {
-	router_ptr_ = std::make_unique<graph::Router<double>>(network_graph_);
+	if (settings_.mode == RouterMode::ALL_PAIRS) {
+		router_ptr_ = std::make_unique<graph::Router<GraphTime>>(network_graph_, settings_.all_pairs_algorithm);
+	}
 }
 
 
-TransportRouteInfo TransportGraphWrapper::PostProcessFindRoute(std::optional<graph::Router<double>::RouteInfo> route) const {
+TransportRouteInfo TransportGraphWrapper::PostProcessFindRoute(std::optional<graph::Router<GraphTime>::RouteInfo> route,
+	const RoutingSettings* metric) const {
 	if (route != std::nullopt) {
-		double total_time = route->weight;
-		std::vector<std::variant<WaitItem, BusItem>> items;
+		//the exact times of the edges, not the rounded weight of the route
+		double total_time = 0;
+		std::vector<RouteItem> items;
 
+		//RIDE_VERTICES model: the ride edges between board and alight make one BusItem
+		BusItem ride{};
 		for (const auto edge : route->edges) {
-			EdgeData context = edgeid_to_data.at(edge);
+			const EdgeData& context = edgeid_to_data.at(edge);
+			const double time = metric ? GetEdgeTime(context, *metric) : context.time;
+			total_time += time;
 			if (context.type == EdgeType::WAIT) {
-				items.push_back(WaitItem{ context.waiting_stop->stop_name,context.time });
+				items.push_back(WaitItem{ context.waiting_stop->stop_name,time });
 			}
 			else if (context.type == EdgeType::BUS) {
-				items.push_back(BusItem{ context.bus->bus_name,context.time,context.span_count });
+				items.push_back(BusItem{ context.bus->bus_name,time,context.span_count });
+			}
+			else if (context.type == EdgeType::BOARD) {
+				items.push_back(WaitItem{ context.waiting_stop->stop_name,time });
+				ride = BusItem{ context.bus->bus_name, 0, 0 };
+			}
+			else if (context.type == EdgeType::RIDE) {
+				ride.time += time;
+				ride.span_count += context.span_count;
+			}
+			else if (context.type == EdgeType::ALIGHT) {
+				items.push_back(ride);
 			}
 
 		}
@@ -107,3 +509,44 @@ TransportRouteInfo TransportGraphWrapper::PostProcessFindRoute(std::optional<gra
 	return { false,0,{} };
 }
 
+
+double TransportGraphWrapper::GetEdgeTime(const EdgeData& data, const RoutingSettings& metric) {
+	switch (data.type) {
+	case EdgeType::WAIT:
+	case EdgeType::BOARD:
+		return metric.wait_time;
+	case EdgeType::BUS:
+	case EdgeType::RIDE:
+		return catalogue::TransportCatalogue::ConvertToTime(data.distance, metric.velocity);
+	case EdgeType::ALIGHT:
+		return 0;
+	}
+	return 0;
+}
+
+
+void TransportGraphWrapper::SortEdgesBySource() {
+	std::vector<graph::EdgeId> order(edgeid_to_data.size());
+	std::iota(order.begin(), order.end(), 0);
+	//stable: the incidence list of a vertex keeps its order
+	std::stable_sort(order.begin(), order.end(), [this](graph::EdgeId lhs, graph::EdgeId rhs) {
+		return network_graph_.GetEdge(lhs).from < network_graph_.GetEdge(rhs).from;
+	});
+	graph::DirectedWeightedGraph<GraphTime> sorted_graph(network_graph_.GetVertexCount());
+	std::vector<EdgeData> sorted_data;
+	sorted_data.reserve(order.size());
+	for (graph::EdgeId id : order) {
+		sorted_graph.AddEdge(network_graph_.GetEdge(id));
+		sorted_data.push_back(edgeid_to_data[id]);
+	}
+	network_graph_ = std::move(sorted_graph);
+	edgeid_to_data = std::move(sorted_data);
+}
+
+graph::EdgeId TransportGraphWrapper::AddEdge(graph::VertexId from, graph::VertexId to, EdgeData data) {
+	graph::EdgeId id = network_graph_.AddEdge({ from, to, ToGraphTime(data.time) });
+	//edges are numbered in the order they are added
+	edgeid_to_data.push_back(data);
+	return id;
+}
+
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <variant>
 #include <vector>
 #include <memory>
 #include "graph.h"
 #include "router.h"
+#include "dijkstra.h"
+#include "hub_labels.h"
+#include "lru_cache.h"
+#include "thread_pool.h"
 #include "transport_catalogue.h"
 
 
@@ -22,10 +28,22 @@ struct BusItem {
 };
 
 
+/// <summary>
+/// Walk between a point and a stop. The side without a stop name is the point.
+/// </summary>
+struct WalkItem {
+	std::string from_stop;
+	std::string to_stop;
+	double time;
+	double distance;
+};
+
+using RouteItem = std::variant<WaitItem, BusItem, WalkItem>;
+
 struct TransportRouteInfo {
 	bool rout_exists;
 	double total_time;
-	std::vector<std::variant<WaitItem, BusItem>> items;
+	std::vector<RouteItem> items;
 };
 
 
@@ -34,29 +52,128 @@ struct RouteRequest {
 	catalogue::Stop* toStop;
 };
 
+/// <summary>
+/// How routes are searched.
+/// ALL_PAIRS: all routes are precomputed by graph::Router when the graph is built.
+/// PER_QUERY: nothing is precomputed, every origin gets its own Dijkstra search
+/// (a bidirectional one when a single route is asked).
+/// </summary>
+enum class RouterMode {
+	ALL_PAIRS,
+	PER_QUERY
+};
+
+/// <summary>
+/// How bus lines are put in the graph.
+/// STOP_PAIRS: one edge for every (board, alight) pair of stops of a line: O(n^2) edges per line.
+/// RIDE_VERTICES: one "ride" vertex per stop of every trip of a line, chained by edges between
+/// consecutive stops. Boarding (waiting vertex => ride vertex) carries the wait time,
+/// alighting (ride vertex => waiting vertex) is free: O(n) edges per line.
+/// </summary>
+enum class GraphModel {
+	STOP_PAIRS,
+	RIDE_VERTICES
+};
+
+/// <summary>
+/// Order of the stops' vertexes in the graph.
+/// ALPHABETICAL: by stop name.
+/// HILBERT: along a Hilbert curve over the stops' coordinates: close stops get close vertex ids,
+/// so a search reads fewer distinct cache lines of the graph and of its own arrays.
+/// </summary>
+enum class VertexOrder {
+	ALPHABETICAL,
+	HILBERT
+};
+
+/// <summary>
+/// Engine of the TimetableRoute requests (routes over the bus departures).
+/// RAPTOR: rounds of route scans, one per ride (TimetableRouter).
+/// CONNECTION_SCAN: one scan of all the connections sorted by departure (ConnectionScanRouter).
+/// </summary>
+enum class TimetableEngine {
+	RAPTOR,
+	CONNECTION_SCAN
+};
+
+/// <summary>
+/// Weight of the graph edges: time in centiseconds. Integer weights are added exactly and let
+/// the searches use a radix heap. Route items and totals are reported in minutes from the
+/// edges' raw data, so the rounding only matters between routes within centiseconds.
+/// </summary>
+using GraphTime = uint64_t;
+
+inline const double GRAPH_TIME_PER_MINUTE = 6000;
+
+inline const double DEFAULT_WALK_VELOCITY = 5;
+inline const double DEFAULT_WALK_RADIUS = 1000;
+
 struct RoutingSettings {
 	double velocity;
 	double wait_time;
+	RouterMode mode = RouterMode::ALL_PAIRS;
+	GraphModel graph_model = GraphModel::STOP_PAIRS;
+	//how the ALL_PAIRS route matrix is computed
+	graph::AllPairsAlgorithm all_pairs_algorithm = graph::AllPairsAlgorithm::FLOYD_WARSHALL;
+	//hub labels are computed at make_base and stored in the base (TravelTime requests)
+	bool hub_labels = false;
+	TimetableEngine timetable_engine = TimetableEngine::RAPTOR;
+	VertexOrder vertex_order = VertexOrder::ALPHABETICAL;
+	//walking speed in km/h, for routes between points
+	double walk_velocity = DEFAULT_WALK_VELOCITY;
+	//longest walk in meters between a point and a stop (or between two points)
+	double walk_radius = DEFAULT_WALK_RADIUS;
+};
+
+/// <summary>
+/// Velocity and/or wait time of one query instead of the ones the graph was built with.
+/// </summary>
+struct RoutingOverride {
+	std::optional<double> velocity;
+	std::optional<double> wait_time;
+
+	bool IsEmpty() const {
+		return !velocity && !wait_time;
+	}
+};
+
+/// <summary>
+/// A stop that can be reached on foot from a point, distance in meters.
+/// </summary>
+struct StopAccess {
+	catalogue::Stop* stop;
+	double distance;
 };
 
 
 
 enum class EdgeType {
 	WAIT,
-	BUS
+	BUS,
+	//RIDE_VERTICES model only
+	BOARD,
+	RIDE,
+	ALIGHT
 };
 
+/// <summary>
+/// Raw data of an edge. The weight of an edge only depends on type, distance and the routing
+/// settings (see TransportGraphWrapper::GetEdgeTime), so other settings need no rebuild.
+/// </summary>
 struct EdgeData {
 	EdgeType type;
 	catalogue::Bus* bus; // nullptr if WAIT
-	catalogue::Stop* waiting_stop; // nullptr if BUS 
-	double time;
-	int span_count; // 0 if WAIT
+	catalogue::Stop* waiting_stop; // nullptr if BUS, RIDE, ALIGHT
+	double time; // with the settings of the graph
+	int span_count; // 0 if WAIT, BOARD, ALIGHT
+	double distance; // road distance in meters, 0 if WAIT, BOARD, ALIGHT
 };
 
 enum class VertexType {
 	WAITINGVERTEX,
-	REALSTOP
+	REALSTOP,
+	//a stop of a trip of a bus (RIDE_VERTICES model)
+	RIDE
 };
 
 
@@ -65,10 +182,26 @@ struct VertexData {
 	catalogue::Stop* stop;
 };
 
+/// <summary>
+/// Hasher for a pair of VertexId
+/// </summary>
+struct VertexPairHasher {
+	size_t operator()(std::pair<graph::VertexId, graph::VertexId> pair_id) const {
+		std::hash<graph::VertexId> id_hasher;
+		return id_hasher(pair_id.first) + 41 * id_hasher(pair_id.second);
+	}
+};
+
+/// <summary>
+/// Number of finished routes kept by default in the route cache.
+/// </summary>
+inline const size_t DEFAULT_ROUTE_CACHE_CAPACITY = 4096;
+
 class TransportGraphWrapper {
 public:
 	
-	TransportGraphWrapper(RoutingSettings settings, catalogue::TransportCatalogue& tc);
+	TransportGraphWrapper(RoutingSettings settings, catalogue::TransportCatalogue& tc,
+		size_t route_cache_capacity = DEFAULT_ROUTE_CACHE_CAPACITY);
 
 
 	/// <summary>
@@ -78,7 +211,84 @@ public:
 	/// </summary>
 	void BuildTransportGraph();
 
-	TransportRouteInfo FindRoute(RouteRequest request) const;
+	/// <summary>
+	/// Find route between two stops. Finished routes are kept in a bounded LRU cache
+	/// keyed by the pair of stop vertexes, so popular pairs are not searched again.
+	/// </summary>
+	std::shared_ptr<const TransportRouteInfo> FindRoute(RouteRequest request) const;
+
+	/// <summary>
+	/// Find route between two stops with another velocity and/or wait time. The graph is not
+	/// rebuilt: one bidirectional search derives the edges' weights from their raw data. Not cached.
+	/// </summary>
+	TransportRouteInfo FindRoute(RouteRequest request, const RoutingOverride& routing_override) const;
+
+	/// <summary>
+	/// Find routes from one stop to several stops with a single search (PER_QUERY mode):
+	/// the search stops as soon as every target is settled. Result[i] is the route to to_stops[i].
+	/// A single uncached target is searched from both ends.
+	/// </summary>
+	std::vector<std::shared_ptr<const TransportRouteInfo>> FindRoutesFromOrigin(
+		catalogue::Stop* from_stop,
+		const std::vector<catalogue::Stop*>& to_stops) const;
+
+	/// <summary>
+	/// Travel times from every from_stops[i] to every to_stops[j] (result[i][j]),
+	/// std::nullopt if there is no route. Only times are computed, routes are not built.
+	/// Many-to-many with target buckets: every target vertex holds the bucket of the columns
+	/// it answers, one search per origin stops when all buckets are reached.
+	/// Origins are processed in parallel on thread_count threads.
+	/// </summary>
+	std::vector<std::vector<std::optional<double>>> ComputeTravelTimes(
+		const std::vector<catalogue::Stop*>& from_stops,
+		const std::vector<catalogue::Stop*>& to_stops,
+		size_t thread_count = parallel::DefaultThreadCount()) const;
+
+	/// <summary>
+	/// Stops reachable from from_stop within time_budget minutes with their earliest arrival
+	/// time, closest first (from_stop itself comes first with 0). The search is bounded by the
+	/// budget, so only the reachable part of the graph is visited.
+	/// </summary>
+	std::vector<std::pair<catalogue::Stop*, double>> FindReachableStops(catalogue::Stop* from_stop, double time_budget) const;
+
+	/// <summary>
+	/// Best route between two points: walk to one of origins, ride, walk from one of destinations.
+	/// One search is seeded by all origin stops (walk time as initial distance) and stops as soon as
+	/// no destination can improve the best arrival. Walking the whole way (direct_walk meters) is
+	/// used if it is within walk_radius and faster. Route totals include the walks.
+	/// </summary>
+	TransportRouteInfo FindRouteBetweenPoints(
+		const std::vector<StopAccess>& origins,
+		const std::vector<StopAccess>& destinations,
+		double direct_walk) const;
+
+	/// <summary>
+	/// Travel time between two stops from the hub labels, or from an ordinary route search
+	/// if there are none. Route items are filled (unpacked from the labels) only if with_items.
+	/// Without items total_time is the graph time, rounded to centiseconds per edge.
+	/// </summary>
+	TransportRouteInfo FindTravelTime(RouteRequest request, bool with_items) const;
+
+	/// <summary>
+	/// Compute the hub labels of the graph.
+	/// </summary>
+	void BuildHubLabels();
+
+	/// <summary>
+	/// Use hub labels computed before for the same catalogue and settings.
+	/// Throws std::invalid_argument if they do not match the graph.
+	/// </summary>
+	void LoadHubLabels(graph::HubLabelStorage<GraphTime> storage);
+
+	/// <summary>
+	/// nullptr if there are no hub labels.
+	/// </summary>
+	const graph::HubLabels<GraphTime>* GetHubLabels() const;
+
+	/// <summary>
+	/// Hit/miss counters of the route cache.
+	/// </summary>
+	cache::CacheStats GetRouteCacheStats() const;
 
 private:
 	/// <summary>
@@ -91,13 +301,29 @@ private:
 	/// </summary>
 	void AddWaitingEdges();
 
+	/// <summary>
+	/// Stops in the network in the order of their vertexes (settings vertex_order).
+	/// </summary>
+	std::vector<catalogue::Stop*> GetStopsInVertexOrder() const;
+
+	/// <summary>
+	/// Renumber the edges by source vertex once all are added (HILBERT vertex order): the edges
+	/// a search relaxes from close vertexes are close in memory too.
+	/// </summary>
+	void SortEdgesBySource();
+
 	/// <summary>
 	/// Add Bus connections edges.
 	/// </summary>
 	void AddBusEdges();
 
 	/// <summary>
-	/// Create router from graph.
+	/// Add ride vertexes and board/ride/alight edges (RIDE_VERTICES model).
+	/// </summary>
+	void AddRideEdges();
+
+	/// <summary>
+	/// Create router from graph (ALL_PAIRS mode only).
 	/// </summary>
 	void InitializeRouter();
 
@@ -107,15 +333,41 @@ private:
 	/// </summary>
 	/// <param name="route"></param>
 	/// <returns></returns>
-	TransportRouteInfo PostProcessFindRoute(std::optional<graph::Router<double>::RouteInfo> route) const;
+	TransportRouteInfo PostProcessFindRoute(std::optional<graph::Router<GraphTime>::RouteInfo> route,
+		const RoutingSettings* metric = nullptr) const;
+
+	/// <summary>
+	/// Minutes => weight of the graph (rounded to the closest centisecond).
+	/// </summary>
+	static GraphTime ToGraphTime(double minutes);
+
+	static double ToMinutes(GraphTime time);
+
+	/// <summary>
+	/// Weight of an edge under the given settings.
+	/// </summary>
+	static double GetEdgeTime(const EdgeData& data, const RoutingSettings& metric);
+
+	/// <summary>
+	/// Add the edge to the graph with its data.
+	/// </summary>
+	graph::EdgeId AddEdge(graph::VertexId from, graph::VertexId to, EdgeData data);
+
+	/// <summary>
+	/// Minutes to walk the distance (meters).
+	/// </summary>
+	double GetWalkTime(double distance) const;
 
 
 	/// <summary>
 	/// Store the information about the given Edge: bus_name/time needed/...
 	/// </summary>
-	std::map<graph::EdgeId, EdgeData> edgeid_to_data;
+	std::vector<EdgeData> edgeid_to_data;
 
-	std::map<graph::VertexId, VertexData> vertexid_to_data;
+	/// <summary>
+	/// Stop (and type) of every vertex, by VertexId.
+	/// </summary>
+	std::vector<VertexData> vertexid_to_data;
 
 	/// <summary>
 	/// Store info to retrieve VertexId from Stop*.
@@ -134,9 +386,15 @@ private:
 	RoutingSettings settings_ ;
 
 	
-	graph::DirectedWeightedGraph<double> network_graph_;
+	graph::DirectedWeightedGraph<GraphTime> network_graph_;
+
+	std::unique_ptr<graph::Router<GraphTime>> router_ptr_;
 
-	std::unique_ptr<graph::Router<double>> router_ptr_;
+	std::unique_ptr<graph::HubLabels<GraphTime>> hub_labels_;
 
+	/// <summary>
+	/// Finished routes by (from, to) stop vertexes.
+	/// </summary>
+	mutable cache::LruCache<std::pair<graph::VertexId, graph::VertexId>, std::shared_ptr<const TransportRouteInfo>, VertexPairHasher> route_cache_;
 
 };
\ No newline at end of file